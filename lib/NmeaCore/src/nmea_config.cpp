@@ -0,0 +1,104 @@
+#include "nmea_config.h"
+#include <string.h>
+
+static const uint8_t MAGIC[4]={'N','M','C','F'};
+static const size_t  HEADER=8;     // magic + version + len
+
+uint32_t nmeaCrc32(const uint8_t* d, size_t n){
+  uint32_t c=0xFFFFFFFF;
+  for(size_t i=0;i<n;i++){
+    c^=d[i];
+    for(int k=0;k<8;k++) c=(c>>1)^(0xEDB88320 & (0-(c&1)));
+  }
+  return ~c;
+}
+
+void configDefaults(NmeaConfig& c){
+  memset(&c,0,sizeof(c));
+  c.baud=4800; c.mode=0;
+  slotDefaults(c.slots);
+  c.filterMask=(1u<<NMEA_CAT_COUNT)-1;
+  c.monRunning=false; c.genRunning=false;   // arranca pausado
+}
+
+// ============ Writer / Reader ============
+struct Writer {
+  uint8_t* p; size_t cap, n; bool ok;
+  void u8(uint8_t v){ if(n+1>cap){ ok=false; return; } p[n++]=v; }
+  void u16(uint16_t v){ u8((uint8_t)v); u8((uint8_t)(v>>8)); }
+  void u32(uint32_t v){ u16((uint16_t)v); u16((uint16_t)(v>>16)); }
+  void str(const char* s, size_t max){
+    size_t l=strnlen(s,max-1); u8((uint8_t)l);
+    if(n+l>cap){ ok=false; return; }
+    memcpy(p+n,s,l); n+=l;
+  }
+};
+
+struct Reader {
+  const uint8_t* p; size_t n, i; bool ok;
+  uint8_t  u8(){ if(i+1>n){ ok=false; return 0; } return p[i++]; }
+  uint16_t u16(){ uint16_t v=u8(); return (uint16_t)(v|(u8()<<8)); }
+  uint32_t u32(){ uint32_t v=u16(); return v|((uint32_t)u16()<<16); }
+  void str(char* out, size_t max){
+    size_t l=u8();
+    if(!ok || l>max-1 || i+l>n){ ok=false; out[0]=0; return; }
+    memcpy(out,p+i,l); out[l]=0; i+=l;
+  }
+};
+
+// ============ Encode / Decode ============
+size_t configEncode(const NmeaConfig& c, uint8_t* out, size_t cap, uint16_t version){
+  if(version<1 || version>CONFIG_VERSION) return 0;
+  Writer w{out,cap,0,true};
+  for(uint8_t m:MAGIC) w.u8(m);
+  w.u16(version); w.u16(0);                 // len se completa al final
+
+  w.u32(c.baud); w.u8(c.mode);
+  for(const GenSlot& s:c.slots.slot){
+    w.u8(s.enabled?1:0);
+    w.str(s.sensor,sizeof(s.sensor));
+    w.str(s.sentence,sizeof(s.sentence));
+    w.str(s.text,sizeof(s.text));
+    w.u32(s.intervalMs);
+  }
+  if(version>=2){
+    w.u16(c.filterMask);
+    w.u8((c.monRunning?1:0)|(c.genRunning?2:0));
+  }
+
+  if(!w.ok || w.n+4>cap) return 0;
+  size_t len=w.n-HEADER;
+  out[6]=(uint8_t)len; out[7]=(uint8_t)(len>>8);
+  uint32_t crc=nmeaCrc32(out,w.n);
+  w.u32(crc);
+  return w.ok? w.n : 0;
+}
+
+bool configDecode(const uint8_t* in, size_t n, NmeaConfig& out){
+  if(n<HEADER+4 || memcmp(in,MAGIC,4)!=0) return false;
+  Reader r{in,n,4,true};
+  uint16_t version=r.u16(), len=r.u16();
+  if(version<1 || version>CONFIG_VERSION) return false;
+  if(HEADER+len+4!=n) return false;
+  uint32_t crc=(uint32_t)in[n-4]|((uint32_t)in[n-3]<<8)|((uint32_t)in[n-2]<<16)|((uint32_t)in[n-1]<<24);
+  if(nmeaCrc32(in,n-4)!=crc) return false;
+  r.n=n-4;
+
+  NmeaConfig c; configDefaults(c);          // campos de versiones posteriores quedan por defecto
+  c.baud=r.u32(); c.mode=r.u8();
+  for(GenSlot& s:c.slots.slot){
+    s.enabled=r.u8()!=0;
+    r.str(s.sensor,sizeof(s.sensor));
+    r.str(s.sentence,sizeof(s.sentence));
+    r.str(s.text,sizeof(s.text));
+    s.intervalMs=r.u32();
+  }
+  if(version>=2){
+    c.filterMask=r.u16();
+    uint8_t run=r.u8();
+    c.monRunning=run&1; c.genRunning=(run&2)!=0;
+  }
+  if(!r.ok || r.i!=r.n) return false;
+  out=c;
+  return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "nmea_slots.h"
+
+/* ==============================================================
+   Configuración persistente (blob binario versionado + CRC32)
+   ---------------------------------------------------------------
+   Blob:  "NMCF" | version u16 | len u16 | payload | crc32 u32
+          little-endian, strings como u8 len + bytes.
+   • Cada versión solo agrega campos al final del payload: un blob
+     viejo se lee hasta donde llega y el resto queda por defecto.
+       v1  baud, modo, slots (enable/sensor/sentence/text/interval)
+       v2  + máscara de filtros del Monitor + estado running
+   • Blob corrupto, truncado o de versión futura → false (defaults).
+   ============================================================== */
+
+#define CONFIG_VERSION   2
+#define CONFIG_MAX_BLOB  1024
+
+struct NmeaConfig {
+  // v1
+  uint32_t baud;
+  uint8_t  mode;            // 0 = monitor, 1 = generator
+  SlotTable slots;
+  // v2
+  uint16_t filterMask;      // bit por NmeaCategory
+  bool     monRunning;
+  bool     genRunning;
+};
+
+uint32_t nmeaCrc32(const uint8_t* d, size_t n);
+
+void   configDefaults(NmeaConfig& c);
+// version < CONFIG_VERSION solo para tests de migración; devuelve bytes (0 si no entra)
+size_t configEncode(const NmeaConfig& c, uint8_t* out, size_t cap, uint16_t version=CONFIG_VERSION);
+bool   configDecode(const uint8_t* in, size_t n, NmeaConfig& c);
+
+// Junta ráfagas de cambios (un keystroke = un request) en una sola escritura:
+// guarda tras quietMs sin cambios, o como mucho maxMs después del primero.
+class SaveDebouncer {
+public:
+  SaveDebouncer(uint32_t quietMs, uint32_t maxMs): quiet(quietMs), maxWait(maxMs) {}
+  void touch(uint32_t nowMs){ if(!dirty){ dirty=true; first=nowMs; } last=nowMs; }
+  bool due(uint32_t nowMs) const { return dirty && (nowMs-last>=quiet || nowMs-first>=maxWait); }
+  void saved(){ dirty=false; }
+  bool pending() const { return dirty; }
+private:
+  uint32_t quiet, maxWait, first=0, last=0;
+  bool     dirty=false;
+};
@@ -0,0 +1,201 @@
+#include "nmea_core.h"
+#include <string.h>
+
+// ============ Checksum ============
+uint8_t nmeaXor(const char* p, size_t n){
+  uint8_t cs=0; for(size_t i=0;i<n;i++) cs^=(uint8_t)p[i];
+  return cs;
+}
+void nmeaHex(uint8_t cs, char out[2]){
+  static const char H[]="0123456789ABCDEF";
+  out[0]=H[cs>>4]; out[1]=H[cs&0x0F];
+}
+size_t nmeaFinalize(char* out, size_t cap, char start, const char* payload, size_t n){
+  size_t need=(start?1:0)+n+3;                 // [start] payload * HH
+  if(need+1>cap) return 0;
+  char* w=out;
+  if(start) *w++=start;
+  memcpy(w,payload,n); w+=n;
+  *w++='*'; nmeaHex(nmeaXor(payload,n),w); w+=2;
+  *w=0;
+  return need;
+}
+
+// ============ Clasificador ============
+static inline char up(char c){ return (c>='a'&&c<='z')? (char)(c-32) : c; }
+static constexpr uint32_t K(const char* s){ return ((uint32_t)(uint8_t)s[0]<<16)|((uint32_t)(uint8_t)s[1]<<8)|(uint8_t)s[2]; }
+
+bool nmeaIsSentence(const char* line, size_t n){ return n>0 && (line[0]=='$'||line[0]=='!'); }
+
+NmeaCategory nmeaClassify(const char* line, size_t n){
+  if(n>0 && line[0]=='!') return NMEA_CAT_AIS;
+  if(n<6 || line[0]!='$') return NMEA_CAT_OTROS;
+  const char f[3]={up(line[3]),up(line[4]),up(line[5])};
+  switch(K(f)){
+    case K("GLL"): case K("RMC"): case K("VTG"): case K("GGA"): case K("GSA"): case K("GSV"):
+    case K("DTM"): case K("ZDA"): case K("GNS"): case K("GST"): case K("GBS"): case K("GRS"):
+    case K("RMB"): case K("RTE"): case K("BOD"): case K("XTE"):
+      return NMEA_CAT_GPS;
+    case K("DBT"): case K("DPT"): case K("DBK"): case K("DBS"):
+      return NMEA_CAT_SOUNDER;
+    case K("MWD"): case K("MWV"): case K("VWR"): case K("VWT"): case K("MTW"): case K("MTA"):
+    case K("MMB"): case K("MHU"): case K("MDA"):
+      return NMEA_CAT_WEATHER;
+    case K("HDG"): case K("HDT"): case K("HDM"): case K("THS"): case K("ROT"): case K("RSA"):
+      return NMEA_CAT_HEADING;
+    case K("VHW"): case K("VLW"): case K("VBW"):
+      return NMEA_CAT_SPEED;
+    case K("TLL"): case K("TTM"): case K("TLB"): case K("OSD"):
+      return NMEA_CAT_RADAR;
+    case K("XDR"):
+      return NMEA_CAT_TRANSDUCER;
+  }
+  return NMEA_CAT_OTROS;
+}
+
+const char* nmeaCategoryName(NmeaCategory c){
+  static const char* const N[NMEA_CAT_COUNT]={"GPS","AIS","SOUNDER","SPEED","HEADING","RADAR","WEATHER","TRANSDUCER","OTROS"};
+  return (c<NMEA_CAT_COUNT)? N[c] : "OTROS";
+}
+
+// ============ Framer ============
+bool NmeaFramer::push(char c){
+  if(ready){ len=0; start=0; ready=false; }
+
+  // CR o LF cierran la línea
+  if(c=='\n' || c=='\r'){
+    if(overflow){ overflow=false; len=0; return false; }
+    while(len>0 && buf[len-1]==' ') len--;
+    while(start<len && buf[start]==' ') start++;
+    if(start==len){ len=0; start=0; return false; }
+    buf[len]=0; ready=true;
+    return true;
+  }
+  if(c<32 || c>126 || overflow) return false;
+  if(len+1>=sizeof(buf)){ overflow=true; dropped++; return false; }
+  buf[len++]=c;
+  return false;
+}
+
+// ============ Builders ============
+struct GenTemplate { const char* talker; const char* code; const char* fields; };
+
+// GPS: talker fijo por sentencia (GNS usa GN)
+static const GenTemplate GPS_T[]={
+  {"GP","RMC","123519,A,4807.038,N,01131.000,E,5.5,054.7,230394,003.1,W"},
+  {"GP","GGA","123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"},
+  {"GP","GLL","4916.45,N,12311.12,W,225444,A"},
+  {"GP","VTG","054.7,T,034.4,M,005.5,N,010.2,K"},
+  {"GP","GSA","A,3,04,05,09,12,24,25,29,31,,,,,2.5,1.3,2.1"},
+  {"GP","GSV","2,1,08,01,40,083,41,02,17,308,43,12,07,021,42,14,25,110,45"},
+  {"GP","DTM","W84,,0.0,N,0.0,E,0.0,W84"},
+  {"GP","ZDA","201530.00,04,07,2002,00,00"},
+  {"GN","GNS","123519,4807.038,N,01131.000,E,AN,08,0.9,545.4,46.9,,"},
+  {"GP","GST","123519,1.2,1.0,0.8,45.0,0.5,0.5,1.0"},
+  {"GP","GBS","123519,0.5,0.5,0.8,01,0.75,0.00,1.00"},
+  {"GP","GRS","123519,1,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0"},
+  {"GP","RMB","A,0.66,L,ORIG,DEST,4916.45,N,12311.12,W,12.3,054.7,5.5,V"},
+  {"GP","RTE","1,1,c,ROUTE1,WP1,WP2,WP3"},
+  {"GP","BOD","045.0,T,023.0,M,DEST,ORIG"},
+  {"GP","XTE","A,A,0.66,L,N"},
+};
+
+// Resto: se busca por talker del sensor + sentencia
+static const GenTemplate OTHER_T[]={
+  // WEATHER
+  {"II","MWD","054.7,T,034.4,M,10.5,N,5.4,M"},
+  {"II","MWV","054.7,R,10.5,N,A"},
+  {"II","VWR","054.7,R,10.5,N,5.4,M,19.4,K"},
+  {"II","VWT","054.7,T,10.5,N,5.4,M,19.4,K"},
+  {"II","MTW","18.0,C"},
+  {"II","MTA","19.5,C"},
+  {"II","MMB","29.92,I"},
+  {"II","MHU","45.0,P"},
+  {"II","MDA","29.92,I,1.013,B,19.5,C,18.0,C,,"},
+  // HEADING
+  {"HC","HDG","238.5,,E,0.5"},
+  {"HC","HDT","238.5,T"},
+  {"HC","HDM","236.9,M"},
+  {"HC","THS","238.5,A"},
+  {"HC","ROT","0.0,A"},
+  {"HC","RSA","0.0,A,0.0,A"},
+  // SOUNDER
+  {"SD","DBT","036.4,f,011.1,M,006.0,F"},
+  {"SD","DPT","11.2,0.5"},
+  {"SD","DBK","036.4,f,011.1,M,006.0,F"},
+  {"SD","DBS","036.4,f,011.1,M,006.0,F"},
+  // VELOCITY
+  {"II","VHW","054.7,T,034.4,M,5.5,N,10.2,K"},
+  {"II","VLW","12.4,N,0.5,N"},
+  {"II","VBW","5.5,0.1,0.0,5.3,0.1,0.0"},
+  // RADAR
+  {"II","TLL","1,4916.45,N,12311.12,W,225444,TGT1"},
+  {"II","TTM","1,2.5,N,054.7,T,0.0,N,054.7,T,0.0,54.7,TGT1"},
+  {"II","TLB","1,LOCK,4916.45,N,12311.12,W,225444"},
+  {"II","OSD","054.7,A,5.5,N,10.2,K"},
+  // TRANSDUCER
+  {"II","XDR","C,19.5,C,AirTemp"},
+};
+
+static const char AIS_PAYLOAD[]=",1,1,,A,13aG?P0P00PD;88MD5MT?wvl0<0,0";
+
+static bool ieq(const char* a, const char* b){
+  for(;*a&&*b;a++,b++) if(up(*a)!=up(*b)) return false;
+  return *a==*b;
+}
+static bool iprefix(const char* s, const char* p){
+  for(;*p;s++,p++) if(up(*s)!=*p) return false;
+  return true;
+}
+
+static const char* talkerForSensor(const char* s){
+  if(!strcmp(s,"GPS"))     return "GP";
+  if(!strcmp(s,"AIS"))     return "AI";
+  if(!strcmp(s,"SOUNDER")) return "SD";
+  if(!strcmp(s,"HEADING")) return "HC";
+  if(!strcmp(s,"CUSTOM"))  return "";
+  return "II"; // WEATHER / VELOCITY / RADAR / TRANSDUCER
+}
+
+size_t nmeaBuildDollar(char* out, size_t cap, const char* talker, const char* code, const char* fields){
+  char payload[NMEA_MAX_LINE];
+  size_t t=strlen(talker), c=strlen(code), f=strlen(fields);
+  if(t+c+1+f>sizeof(payload)) return 0;
+  memcpy(payload,talker,t); memcpy(payload+t,code,c); payload[t+c]=','; memcpy(payload+t+c+1,fields,f);
+  return nmeaFinalize(out,cap,'$',payload,t+c+1+f);
+}
+
+size_t nmeaGenerate(char* out, size_t cap, const char* sensor, const char* codeIn){
+  if(cap) out[0]=0;
+  if(ieq(sensor,"CUSTOM")||ieq(codeIn,"CUSTOM")) return 0;
+  char c[8]; size_t n=0;
+  for(;codeIn[n] && n<sizeof(c)-1;n++) c[n]=up(codeIn[n]);
+  c[n]=0;
+  const char* t=talkerForSensor(sensor);
+
+  if(!strcmp(sensor,"AIS")){
+    char payload[sizeof(AIS_PAYLOAD)+5];
+    memcpy(payload,!strcmp(c,"AIVDO")?"AIVDO":"AIVDM",5); memcpy(payload+5,AIS_PAYLOAD,sizeof(AIS_PAYLOAD)-1);
+    return nmeaFinalize(out,cap,'!',payload,sizeof(payload)-1);
+  }
+
+  if(!strcmp(sensor,"GPS")){
+    for(const GenTemplate& g:GPS_T) if(!strcmp(g.code,c)) return nmeaBuildDollar(out,cap,g.talker,g.code,g.fields);
+  } else {
+    for(const GenTemplate& g:OTHER_T) if(!strcmp(g.talker,t)&&!strcmp(g.code,c)) return nmeaBuildDollar(out,cap,g.talker,g.code,g.fields);
+  }
+  return nmeaBuildDollar(out,cap,t,c,"");
+}
+
+size_t nmeaNormalize(char* out, size_t cap, const char* text){
+  if(cap) out[0]=0;
+  while(*text==' ') text++;
+  if(!*text) return 0;
+  char ch=text[0];
+  if(ch=='$'||ch=='!') text++;
+  else ch=(iprefix(text,"AIVDM")||iprefix(text,"AIVDO"))? '!' : '$';
+  const char* star=strchr(text,'*');
+  size_t n=star? (size_t)(star-text) : strlen(text);
+  while(n>0 && text[n-1]==' ') n--;
+  return nmeaFinalize(out,cap,ch,text,n);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ==============================================================
+   Núcleo NMEA independiente de plataforma
+   ---------------------------------------------------------------
+   • Checksum XOR + hex, clasificador por formatter, framer de
+     líneas, builders del Generator.
+   • Sin Arduino String ni heap: todo trabaja sobre buffers del
+     llamador, así compila igual en ESP32 y en el env native.
+   ============================================================== */
+
+// Línea NMEA máxima que se guarda (82 del estándar + margen), incluye '\0'
+#define NMEA_MAX_LINE 128
+
+// ===== Checksum =====
+uint8_t nmeaXor(const char* p, size_t n);
+void    nmeaHex(uint8_t cs, char out[2]);
+// start + payload + '*' + HH  → devuelve longitud (0 si no entra)
+size_t  nmeaFinalize(char* out, size_t cap, char start, const char* payload, size_t n);
+
+// ===== Clasificador =====
+enum NmeaCategory : uint8_t {
+  NMEA_CAT_GPS=0, NMEA_CAT_AIS, NMEA_CAT_SOUNDER, NMEA_CAT_SPEED, NMEA_CAT_HEADING,
+  NMEA_CAT_RADAR, NMEA_CAT_WEATHER, NMEA_CAT_TRANSDUCER, NMEA_CAT_OTROS,
+  NMEA_CAT_COUNT
+};
+bool         nmeaIsSentence(const char* line, size_t n);   // empieza con '$' o '!'
+NmeaCategory nmeaClassify(const char* line, size_t n);
+const char*  nmeaCategoryName(NmeaCategory c);             // "GPS", "AIS", ... "OTROS"
+
+// ===== Framer =====
+// Acumula bytes del UART; CR o LF cierran la línea, solo ASCII imprimible,
+// espacios de los extremos recortados. Líneas más largas que el buffer se descartan.
+class NmeaFramer {
+public:
+  NmeaFramer(){ reset(); }
+  // true cuando c cierra una línea no vacía; queda en line()/length() hasta el próximo push
+  bool push(char c);
+  const char* line()   const { return buf + start; }
+  size_t      length() const { return len - start; }
+  uint32_t    overflows() const { return dropped; }
+  void reset(){ len=0; start=0; ready=false; overflow=false; dropped=0; buf[0]=0; }
+private:
+  char     buf[NMEA_MAX_LINE];
+  size_t   len, start;
+  bool     ready, overflow;
+  uint32_t dropped;
+};
+
+// ===== Builders (Generator) =====
+size_t nmeaBuildDollar(char* out, size_t cap, const char* talker, const char* code, const char* fields);
+// Sentencia de ejemplo para sensor/código; 0 para CUSTOM
+size_t nmeaGenerate(char* out, size_t cap, const char* sensor, const char* code);
+// Texto del editor → línea completa: agrega '$' ('!' para AIVDM/AIVDO) si falta y recalcula *HH
+size_t nmeaNormalize(char* out, size_t cap, const char* text);
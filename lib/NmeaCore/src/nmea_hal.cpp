@@ -0,0 +1,19 @@
+#include "nmea_hal.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "esp_timer.h"
+
+uint32_t halMillis(){ return millis(); }
+uint64_t halMicros(){ return (uint64_t)esp_timer_get_time(); }
+
+#else
+#include <chrono>
+
+static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+uint32_t halMillis(){ return (uint32_t)(halMicros()/1000); }
+uint64_t halMicros(){
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-t0).count();
+}
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+#include <stdint.h>
+
+/* ==============================================================
+   HAL mínima del núcleo NMEA
+   ---------------------------------------------------------------
+   • Lo único que el núcleo necesita de la plataforma.
+   • ESP32: millis()/esp_timer   ·   native: std::chrono
+   ============================================================== */
+
+uint32_t halMillis();
+uint64_t halMicros();
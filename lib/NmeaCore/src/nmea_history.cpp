@@ -0,0 +1,57 @@
+#include "nmea_history.h"
+#include <string.h>
+
+static inline char up(char c){ return (c>='a'&&c<='z')? (char)(c-32) : c; }
+static inline bool alnum(char c){ return (c>='A'&&c<='Z')||(c>='a'&&c<='z')||(c>='0'&&c<='9'); }
+
+uint16_t histTalker(const char* s){
+  if(!s || !alnum(s[0]) || !alnum(s[1])) return 0;
+  return (uint16_t)(((uint8_t)up(s[0])<<8)|(uint8_t)up(s[1]));
+}
+uint32_t histFormatter(const char* s){
+  if(!s || !alnum(s[0]) || !alnum(s[1]) || !alnum(s[2])) return 0;
+  return ((uint32_t)(uint8_t)up(s[0])<<16)|((uint32_t)(uint8_t)up(s[1])<<8)|(uint8_t)up(s[2]);
+}
+
+bool NmeaHistory::begin(void* mem, size_t bytes, uint64_t seq0){
+  cap=mem? bytes/(sizeof(HistEntry)+HIST_TEXT) : 0;
+  idx=(HistEntry*)mem;
+  text=(char*)mem+cap*sizeof(HistEntry);
+  total=base=seq0;
+  return cap>0;
+}
+
+void NmeaHistory::push(const char* line, size_t n, NmeaCategory cat, uint32_t ms){
+  if(!cap) return;
+  if(n>HIST_TEXT-1) n=HIST_TEXT-1;
+  size_t i=slot(total);
+  HistEntry& e=idx[i];
+  e.ms=ms; e.cat=(uint8_t)cat; e.len=(uint8_t)n;
+  // $GPRMC / !AIVDM → talker GP/AI, formatter RMC/VDM
+  bool sentence=nmeaIsSentence(line,n) && n>=6;
+  e.talker   =sentence? histTalker(line+1)    : 0;
+  e.formatter=sentence? histFormatter(line+3) : 0;
+  char* t=text+i*HIST_TEXT;
+  memcpy(t,line,n); t[n]=0;
+  total++;
+}
+
+uint64_t NmeaHistory::seqAt(uint32_t t) const {
+  uint64_t lo=firstSeq(), hi=endSeq();
+  while(lo!=hi){
+    uint64_t mid=lo+(hi-lo)/2;
+    if((int32_t)(idx[slot(mid)].ms-t)<0) lo=mid+1; else hi=mid;
+  }
+  return lo;
+}
+
+bool NmeaHistory::contains(const char* t, size_t n, const char* needle){
+  size_t m=strlen(needle);
+  if(m>n) return false;
+  for(size_t i=0;i+m<=n;i++){
+    size_t k=0;
+    while(k<m && up(t[i+k])==up(needle[k])) k++;
+    if(k==m) return true;
+  }
+  return false;
+}
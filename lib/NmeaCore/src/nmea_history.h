@@ -0,0 +1,107 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "nmea_core.h"
+
+/* ==============================================================
+   Historial grande del Monitor (PSRAM en el ESP32)
+   ---------------------------------------------------------------
+   • Registros de tamaño fijo sobre un bloque que da el llamador,
+     en dos arrays: índice de 12 bytes (ms, talker, formatter,
+     categoría, largo) y texto de HIST_TEXT bytes.
+   • Categoría/talker/formatter/tiempo se filtran solo con el índice;
+     el texto se lee para la búsqueda por substring y los resultados.
+   • Cada línea tiene una secuencia de 64 bits que nunca vuelve atrás
+     (ni al borrar): sirve de cursor para paginar en los dos sentidos
+     y detecta registros pisados.
+   • Sin lock propio: el llamador protege con su mutex y recorre por
+     tramos (budget) para no frenar a TaskNMEA.
+   ============================================================== */
+
+#define HIST_TEXT 96    // 82 del estándar + margen, incluye '\0'; más largo se trunca
+
+struct HistEntry {
+  uint32_t ms;
+  uint32_t formatter;   // "RMC" → 'R'<<16 | 'M'<<8 | 'C'  (0 = sin formatter)
+  uint16_t talker;      // "GP"  → 'G'<<8 | 'P'
+  uint8_t  cat;         // NmeaCategory
+  uint8_t  len;
+};
+
+uint16_t histTalker(const char* s);       // primeras 2 letras, mayúsculas; 0 si no hay
+uint32_t histFormatter(const char* s);    // primeras 3 letras, mayúsculas; 0 si no hay
+
+struct HistQuery {
+  uint16_t    catMask   = 0xFFFF;    // bit por NmeaCategory
+  uint16_t    talker    = 0;         // 0 = cualquiera
+  uint32_t    formatter = 0;         // 0 = cualquiera
+  const char* contains  = nullptr;   // substring sin distinguir mayúsculas
+};
+
+class NmeaHistory {
+public:
+  // Capacidad = bytes / (sizeof(HistEntry)+HIST_TEXT); false si no entra ni uno.
+  // seq0: primera secuencia a asignar
+  bool begin(void* mem, size_t bytes, uint64_t seq0=0);
+  void clear(){ base=total; }   // las secuencias siguen creciendo: cursores viejos no ven datos nuevos
+
+  void push(const char* line, size_t n, NmeaCategory cat, uint32_t ms);
+
+  size_t   capacity() const { return cap; }
+  size_t   size()     const { return (size_t)(total-firstSeq()); }
+  uint64_t firstSeq() const { return total-base<cap? base : total-cap; }   // más vieja que sigue guardada
+  uint64_t endSeq()   const { return total; }                             // próxima a escribir
+
+  // Primera secuencia con ms >= t (los ms no decrecen: búsqueda binaria sobre el índice)
+  uint64_t seqAt(uint32_t t) const;
+
+  // f(seq, entry, text) por cada coincidencia en [from, end), de la más vieja a la
+  // más nueva, mirando como mucho budget registros; f devuelve false para cortar.
+  // Devuelve el próximo from.
+  template<typename F>
+  uint64_t scan(const HistQuery& q, uint64_t from, uint64_t end, size_t budget, F f) const {
+    clampRange(from,end);
+    size_t i=slot(from);
+    for(; from<end && budget>0; from++, budget--){
+      const HistEntry& e=idx[i];
+      const char* t=text+i*HIST_TEXT;
+      if(++i==cap) i=0;
+      if(match(q,e,t) && !f(from,e,t)) return from+1;
+    }
+    return from;
+  }
+
+  // Igual que scan pero de la más nueva a la más vieja. Devuelve el próximo end.
+  template<typename F>
+  uint64_t scanBack(const HistQuery& q, uint64_t from, uint64_t end, size_t budget, F f) const {
+    clampRange(from,end);
+    size_t i=slot(end);
+    for(; end>from && budget>0; end--, budget--){
+      i=(i? i : cap)-1;
+      const HistEntry& e=idx[i];
+      const char* t=text+i*HIST_TEXT;
+      if(match(q,e,t) && !f(end-1,e,t)) return end-1;
+    }
+    return end;
+  }
+
+private:
+  void clampRange(uint64_t& from, uint64_t& end) const {
+    if(from<firstSeq()) from=firstSeq();
+    if(end>endSeq())    end=endSeq();
+    if(end<from)        end=from;
+  }
+  size_t slot(uint64_t seq) const { return cap? (size_t)(seq%cap) : 0; }   // una división por llamada, no por registro
+  static bool match(const HistQuery& q, const HistEntry& e, const char* t){
+    if(!(q.catMask & (1u<<e.cat))) return false;
+    if(q.talker && e.talker!=q.talker) return false;
+    if(q.formatter && e.formatter!=q.formatter) return false;
+    return !(q.contains && *q.contains && !contains(t,e.len,q.contains));
+  }
+  static bool contains(const char* t, size_t n, const char* needle);
+  HistEntry* idx  = nullptr;
+  char*      text = nullptr;
+  size_t     cap  = 0;
+  uint64_t   total= 0;   // próxima secuencia
+  uint64_t   base = 0;   // primera secuencia desde begin/clear
+};
@@ -0,0 +1,35 @@
+#include "nmea_led.h"
+
+uint32_t ledColor(LedEvent e){
+  static const uint32_t C[LED_EVENT_COUNT]={
+    0x00FFFF,   // LED_BOOT   cian
+    0x00FF00,   // LED_RX_OK  verde
+    0x0000FF,   // LED_TX     azul
+    0xFF0000,   // LED_RX_BAD rojo
+  };
+  return (e<LED_EVENT_COUNT)? C[e] : 0;
+}
+
+bool LedScheduler::step(uint32_t events, uint32_t nowMs){
+  if(events){
+    // el bit más alto es el evento más importante del frame
+    int e=31-__builtin_clz(events);
+    if(e>=LED_EVENT_COUNT) e=LED_EVENT_COUNT-1;
+    lit=true; since=nowMs;
+    uint32_t c=ledColor((LedEvent)e);
+    if(c==shown) return false;
+    shown=c;
+    return true;
+  }
+  if(lit && nowMs-since>=hold){
+    lit=false;
+    if(shown){ shown=0; return true; }
+  }
+  return false;
+}
+
+uint32_t LedScheduler::msUntilOff(uint32_t nowMs) const {
+  if(!lit) return UINT32_MAX;
+  uint32_t el=nowMs-since;
+  return (el>=hold)? 0 : hold-el;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+/* ==============================================================
+   LED de estado sin bloquear el camino caliente
+   ---------------------------------------------------------------
+   • Productores (RX/TX) publican eventos en LedMailbox: un
+     fetch_or atómico, sin locks ni llamadas al driver.
+   • Un único consumidor de baja prioridad junta lo publicado en
+     cada frame (LedScheduler) y refresca el pixel como mucho una vez.
+   • Colores de siempre: boot cian, RX ok verde, RX inválida rojo,
+     TX azul. Si coinciden en un frame gana el más importante.
+   ============================================================== */
+
+enum LedEvent : uint8_t { LED_BOOT=0, LED_RX_OK, LED_TX, LED_RX_BAD, LED_EVENT_COUNT };
+
+uint32_t ledColor(LedEvent e);   // 0xRRGGBB
+
+class LedMailbox {
+public:
+  // true si el buzón estaba vacío (recién ahí hace falta despertar al consumidor)
+  bool post(LedEvent e){ return bits.fetch_or(1u<<e, std::memory_order_release)==0; }
+  // Máscara de eventos desde el último take(); deja el buzón vacío
+  uint32_t take(){ return bits.exchange(0, std::memory_order_acquire); }
+private:
+  std::atomic<uint32_t> bits{0};
+};
+
+class LedScheduler {
+public:
+  explicit LedScheduler(uint32_t holdMs=50): hold(holdMs) {}
+  // Procesa un frame; true si hay que mandar color() al pixel
+  bool step(uint32_t events, uint32_t nowMs);
+  uint32_t color() const { return shown; }
+  // ms hasta apagar; UINT32_MAX si ya está apagado
+  uint32_t msUntilOff(uint32_t nowMs) const;
+private:
+  uint32_t hold;
+  uint32_t shown=0, since=0;
+  bool     lit=false;
+};
@@ -0,0 +1,76 @@
+#include "nmea_ota.h"
+#include <string.h>
+
+static const uint8_t IMAGE_MAGIC=0xE9;        // esp_image_header_t.magic
+static const size_t  HASH_APPENDED_AT=23;     // esp_image_header_t.hash_appended
+
+bool OtaPipeline::fail(const char* why){
+  if(st==OTA_RECEIVING) sink.abort();
+  st=OTA_FAILED; err=why;
+  return false;
+}
+
+bool OtaPipeline::begin(size_t expectedSize, const char* sha256Hex, uint32_t nowMs){
+  if(st==OTA_RECEIVING) sink.abort();
+  body.reset(); tailN=0; size=expectedSize; got=0; t0=t1=nowMs; digest[0]=0; err="";
+  st=OTA_IDLE;
+  haveExpected = sha256Hex && sha256Hex[0];
+  if(haveExpected && !Sha256::fromHex(sha256Hex,want)) return fail("bad sha256");
+  if(!sink.begin(size)){ st=OTA_FAILED; err=sink.error(); return false; }
+  st=OTA_RECEIVING;
+  return true;
+}
+
+bool OtaPipeline::write(const uint8_t* d, size_t n, uint32_t nowMs){
+  if(st!=OTA_RECEIVING) return false;
+  if(size && got+n>size) return fail("size exceeded");
+  if(got<sizeof(hdr)){
+    size_t k=n<sizeof(hdr)-got? n : sizeof(hdr)-got;
+    memcpy(hdr+got,d,k);
+    if(got+k==sizeof(hdr)){
+      if(hdr[0]!=IMAGE_MAGIC)        return fail("not an app image");
+      if(hdr[HASH_APPENDED_AT]!=1)   return fail("image has no appended sha256");
+    }
+  }
+  hashBody(d,n);
+  if(sink.write(d,n)!=n) return fail(sink.error());
+  got+=n; t1=nowMs;
+  return true;
+}
+
+bool OtaPipeline::finish(uint32_t nowMs){
+  if(st!=OTA_RECEIVING) return false;
+  t1=nowMs;
+  Sha256 full=body; full.update(tail,tailN);
+  uint8_t dig[32]; full.finish(dig); Sha256::toHex(dig,digest);
+  uint8_t img[32]; body.finish(img);
+  if(got==0)                                  return fail("empty image");
+  if(size && got!=size)                       return fail("size mismatch");
+  if(got<sizeof(hdr)+sizeof(tail))            return fail("not an app image");
+  if(memcmp(img,tail,32)!=0)                  return fail("image sha256 mismatch");
+  if(haveExpected && memcmp(dig,want,32)!=0)  return fail("sha256 mismatch");
+  if(!sink.end()){ st=OTA_FAILED; err=sink.error(); return false; }
+  st=OTA_OK;
+  return true;
+}
+
+void OtaPipeline::abort(const char* why){ fail(why); }
+
+// Lo que sale de la ventana de 32 bytes va al hash del cuerpo
+void OtaPipeline::hashBody(const uint8_t* d, size_t n){
+  if(tailN+n<=sizeof(tail)){ memcpy(tail+tailN,d,n); tailN+=n; return; }
+  size_t out=tailN+n-sizeof(tail);
+  size_t fromTail=out<tailN? out : tailN;
+  body.update(tail,fromTail);
+  body.update(d,out-fromTail);
+  uint8_t next[32]; size_t keep=tailN-fromTail;
+  memcpy(next,tail+fromTail,keep);
+  memcpy(next+keep,d+(out-fromTail),sizeof(tail)-keep);
+  memcpy(tail,next,sizeof(tail)); tailN=sizeof(tail);
+}
+
+uint32_t OtaPipeline::bytesPerSec(uint32_t nowMs) const {
+  uint32_t end=(st==OTA_RECEIVING)? nowMs : t1;
+  uint32_t ms=end-t0;
+  return ms? (uint32_t)((uint64_t)got*1000/ms) : 0;
+}
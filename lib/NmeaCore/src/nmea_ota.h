@@ -0,0 +1,66 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "nmea_sha256.h"
+
+/* ==============================================================
+   Pipeline OTA: upload → SHA-256 → sink de flash
+   ---------------------------------------------------------------
+   • Cada bloque se hashea y se escribe en el mismo paso.
+   • Verificación obligatoria, sin depender del navegador: toda app
+     ESP32 trae al final el SHA-256 del resto de la imagen (header
+     byte 23 = hash_appended). Se hashea todo menos una ventana con
+     los últimos 32 bytes y se compara con ella antes de sink.end().
+     Imagen sin ese hash o que no coincide → sink.abort().
+   • Opcional: digest del archivo entero (sha256sum firmware.bin)
+     pegado en la página; también tiene que coincidir.
+   • OtaSink es la HAL: Update en ESP32, mock en los tests.
+   ============================================================== */
+
+class OtaSink {
+public:
+  virtual ~OtaSink(){}
+  virtual bool   begin(size_t size)=0;                  // 0 = tamaño desconocido
+  virtual size_t write(const uint8_t* d, size_t n)=0;   // bytes aceptados
+  virtual bool   end()=0;                               // confirma la imagen
+  virtual void   abort()=0;
+  virtual const char* error()=0;
+};
+
+enum OtaState : uint8_t { OTA_IDLE=0, OTA_RECEIVING, OTA_OK, OTA_FAILED };
+
+class OtaPipeline {
+public:
+  explicit OtaPipeline(OtaSink& s): sink(s) { digest[0]=0; err=""; }
+
+  // expectedSize 0 = desconocido; sha256Hex NULL/"" = solo el hash embebido
+  bool begin(size_t expectedSize, const char* sha256Hex, uint32_t nowMs);
+  bool write(const uint8_t* d, size_t n, uint32_t nowMs);
+  bool finish(uint32_t nowMs);
+  void abort(const char* why);
+
+  OtaState    state()    const { return st; }
+  size_t      received() const { return got; }
+  size_t      expected() const { return size; }
+  bool        verified() const { return haveExpected && st==OTA_OK; }   // además coincidió el digest pegado
+  const char* error()    const { return err; }
+  const char* digestHex()const { return digest; }        // del archivo entero; "" hasta finish()
+  uint32_t    bytesPerSec(uint32_t nowMs) const;
+
+private:
+  bool fail(const char* why);
+  void hashBody(const uint8_t* d, size_t n);
+
+  OtaSink&    sink;
+  Sha256      body;          // todo menos los últimos 32 bytes
+  uint8_t     tail[32];      // ventana con los últimos 32 bytes recibidos
+  size_t      tailN=0;
+  uint8_t     hdr[24];       // esp_image_header_t
+  OtaState    st=OTA_IDLE;
+  size_t      size=0, got=0;
+  uint32_t    t0=0, t1=0;
+  bool        haveExpected=false;
+  uint8_t     want[32];
+  char        digest[65];
+  const char* err;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* ==============================================================
+   Ring de líneas de tamaño fijo (sin heap)
+   ---------------------------------------------------------------
+   • N registros de W bytes + tag de 1 byte (p.ej. NmeaCategory).
+   • Sin lock propio: el llamador protege con su mutex.
+   ============================================================== */
+
+template<size_t N, size_t W>
+class LineRing {
+public:
+  LineRing(){ clear(); }
+
+  void clear(){ head=0; count=0; }
+
+  // Copia la línea (truncada a W-1) sobre el registro más viejo
+  void push(const char* s, size_t n, uint8_t tag=0){
+    if(n>W-1) n=W-1;
+    Rec& r=recs[head];
+    memcpy(r.text,s,n); r.text[n]=0; r.len=(uint16_t)n; r.tag=tag;
+    head=(head+1)%N;
+    if(count<N) count++;
+  }
+
+  // f(text,len,tag) del más viejo al más nuevo
+  template<typename F> void forEach(F f) const {
+    size_t first=(head+N-count)%N;
+    for(size_t i=0;i<count;i++){ const Rec& r=recs[(first+i)%N]; f(r.text,(size_t)r.len,r.tag); }
+  }
+
+  size_t size() const { return count; }
+  static constexpr size_t capacity(){ return N; }
+
+private:
+  struct Rec { uint16_t len; uint8_t tag; char text[W]; };
+  Rec    recs[N];
+  size_t head, count;
+};
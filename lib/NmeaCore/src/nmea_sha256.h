@@ -0,0 +1,43 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ARDUINO
+#include "mbedtls/sha256.h"
+#endif
+
+/* ==============================================================
+   SHA-256 incremental
+   ---------------------------------------------------------------
+   • ESP32: mbedtls, que en el S3 usa el acelerador SHA por hardware
+     (nmea_sha256_esp.cpp).
+   • env native: implementación portable FIPS 180-4, solo para
+     tests y benchmark (nmea_sha256.cpp).
+   • Copiable: sirve para cerrar un digest parcial y seguir con otro.
+   ============================================================== */
+
+class Sha256 {
+public:
+  Sha256();
+  ~Sha256();
+  Sha256(const Sha256& o);
+  Sha256& operator=(const Sha256& o);
+
+  void reset();
+  void update(const uint8_t* d, size_t n);
+  void finish(uint8_t out[32]);
+  // 64 hex minúsculas + '\0'
+  static void toHex(const uint8_t dig[32], char out[65]);
+  // acepta mayúsculas/minúsculas; false si no son 64 hex
+  static bool fromHex(const char* hex, uint8_t out[32]);
+
+private:
+#ifdef ARDUINO
+  mbedtls_sha256_context ctx;
+#else
+  void block(const uint8_t* p);
+  uint32_t h[8];
+  uint64_t total;
+  uint8_t  buf[64];
+  size_t   used;
+#endif
+};
@@ -0,0 +1,24 @@
+#ifdef ARDUINO
+#include "nmea_sha256.h"
+#include "mbedtls/version.h"
+
+// mbedtls 2.x (Arduino-ESP32 2.x) usa las variantes *_ret; en 3.x se renombraron
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+  #define SHA_STARTS(c)       mbedtls_sha256_starts(c,0)
+  #define SHA_UPDATE(c,d,n)   mbedtls_sha256_update(c,d,n)
+  #define SHA_FINISH(c,o)     mbedtls_sha256_finish(c,o)
+#else
+  #define SHA_STARTS(c)       mbedtls_sha256_starts_ret(c,0)
+  #define SHA_UPDATE(c,d,n)   mbedtls_sha256_update_ret(c,d,n)
+  #define SHA_FINISH(c,o)     mbedtls_sha256_finish_ret(c,o)
+#endif
+
+Sha256::Sha256(){ mbedtls_sha256_init(&ctx); SHA_STARTS(&ctx); }
+Sha256::~Sha256(){ mbedtls_sha256_free(&ctx); }
+Sha256::Sha256(const Sha256& o){ mbedtls_sha256_init(&ctx); mbedtls_sha256_clone(&ctx,&o.ctx); }
+Sha256& Sha256::operator=(const Sha256& o){ if(this!=&o) mbedtls_sha256_clone(&ctx,&o.ctx); return *this; }
+
+void Sha256::reset(){ mbedtls_sha256_free(&ctx); mbedtls_sha256_init(&ctx); SHA_STARTS(&ctx); }
+void Sha256::update(const uint8_t* d, size_t n){ SHA_UPDATE(&ctx,d,n); }
+void Sha256::finish(uint8_t out[32]){ SHA_FINISH(&ctx,out); }
+#endif
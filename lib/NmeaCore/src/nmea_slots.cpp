@@ -0,0 +1,92 @@
+#include "nmea_slots.h"
+#include <stdio.h>
+#include <string.h>
+
+void slotDefaults(SlotTable& t){
+  memset(&t,0,sizeof(t));
+  static const struct { bool en; const char* sensor; const char* sentence; } D[GEN_SLOTS]={
+    {true,"GPS","RMC"},{false,"GPS","VTG"},{false,"VELOCITY","VHW"},{false,"HEADING","HDT"},
+  };
+  for(int i=0;i<GEN_SLOTS;i++){
+    t.slot[i].enabled=D[i].en;
+    strncpy(t.slot[i].sensor,D[i].sensor,sizeof(t.slot[i].sensor)-1);
+    strncpy(t.slot[i].sentence,D[i].sentence,sizeof(t.slot[i].sentence)-1);
+    t.slot[i].intervalMs=500;
+  }
+}
+
+// Copia [s,e) a dst si entra y es alfanumérico
+static bool field(char* dst, size_t cap, const char* s, const char* e){
+  size_t n=(size_t)(e-s);
+  if(n==0 || n>=cap) return false;
+  for(const char* p=s;p<e;p++) if(!((*p>='A'&&*p<='Z')||(*p>='a'&&*p<='z')||(*p>='0'&&*p<='9'))) return false;
+  memcpy(dst,s,n); dst[n]=0;
+  return true;
+}
+
+// [s,e) solo dígitos (uno o más, sin signo ni espacios) → v
+static bool number(long& v, const char* s, const char* e){
+  if(s==e || e-s>9) return false;
+  v=0;
+  for(const char* p=s;p<e;p++){ if(*p<'0'||*p>'9') return false; v=v*10+(*p-'0'); }
+  return true;
+}
+
+static bool fail(char* err, size_t cap, int line, const char* why){
+  if(cap) snprintf(err,cap,"line %d: %s",line,why);
+  return false;
+}
+
+bool slotsParse(const char* body, size_t n, SlotTable& out, char* err, size_t errCap){
+  SlotTable t=out;
+  const char* p=body; const char* end=body+n;
+  int line=0;
+  while(p<end){
+    const char* eol=(const char*)memchr(p,'\n',(size_t)(end-p));
+    if(!eol) eol=end;
+    const char* le=eol;
+    if(le>p && le[-1]=='\r') le--;
+    line++;
+    if(le>p){
+      // slot|enabled|sensor|sentence|intervalMs|text
+      const char* f[6]; const char* q=p; int k=0;
+      f[k++]=q;
+      while(k<6 && q<le){ if(*q=='|') f[k++]=q+1; q++; }
+      if(k<6) return fail(err,errCap,line,"expected 6 fields");
+      long i;
+      if(!number(i,f[0],f[1]-1) || i>=GEN_SLOTS) return fail(err,errCap,line,"bad slot");
+      GenSlot& s=t.slot[i];
+      if(f[2]-f[1]!=2 || (f[1][0]!='0'&&f[1][0]!='1')) return fail(err,errCap,line,"bad enabled");
+      s.enabled=(f[1][0]=='1');
+      if(!field(s.sensor,sizeof(s.sensor),f[2],f[3]-1))     return fail(err,errCap,line,"bad sensor");
+      if(!field(s.sentence,sizeof(s.sentence),f[3],f[4]-1)) return fail(err,errCap,line,"bad sentence");
+      if(!strcmp(s.sensor,"CUSTOM")) strcpy(s.sentence,"CUSTOM");
+      long ms;
+      if(!number(ms,f[4],f[5]-1) || ms<=0) return fail(err,errCap,line,"bad interval");
+      s.intervalMs=(uint32_t)(ms<GEN_MIN_INTERVAL? GEN_MIN_INTERVAL : ms);
+      // Vacío o solo espacios = plantilla del sensor
+      const char* ts=f[5];
+      while(ts<le && *ts==' ') ts++;
+      char text[NMEA_MAX_LINE];
+      size_t tl=(size_t)(le-ts);
+      if(tl>=sizeof(text)) return fail(err,errCap,line,"text too long");
+      memcpy(text,ts,tl); text[tl]=0;
+      if(tl && !nmeaNormalize(s.text,sizeof(s.text),text)) return fail(err,errCap,line,"text too long");
+      if(!tl) s.text[0]=0;
+    }
+    p=eol+1;
+  }
+  out=t;
+  return true;
+}
+
+size_t slotsFormat(const SlotTable& t, char* out, size_t cap){
+  size_t n=0;
+  for(int i=0;i<GEN_SLOTS;i++){
+    const GenSlot& s=t.slot[i];
+    int w=snprintf(out+n,cap-n,"%d|%d|%s|%s|%lu|%s\n",i,s.enabled?1:0,s.sensor,s.sentence,(unsigned long)s.intervalMs,s.text);
+    if(w<0 || (size_t)w>=cap-n){ if(cap) out[0]=0; return 0; }
+    n+=(size_t)w;
+  }
+  return n;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "nmea_core.h"
+
+/* ==============================================================
+   Tabla de slots del Generator
+   ---------------------------------------------------------------
+   • SlotTable es POD: se copia entera, se serializa y se publica
+     de una vez con SwapBuffer (doble buffer).
+   • Formato compacto de /gen_slots, una línea por slot:
+         slot|enabled|sensor|sentence|intervalMs|text
+     text va al final y se toma hasta el fin de línea (puede traer
+     '|', ';' o ',' del payload AIS). Slots no mencionados quedan
+     como estaban; cualquier error rechaza el lote completo.
+   ============================================================== */
+
+#define GEN_SLOTS        4
+#define GEN_MIN_INTERVAL 50
+#define GEN_TEXT_MAX     (NMEA_MAX_LINE-5)   // texto del editor: + '$' + "*HH" + '\0' entra en text
+
+struct GenSlot {
+  bool     enabled;
+  char     sensor[12];      // GPS / WEATHER / HEADING / ... / CUSTOM
+  char     sentence[8];     // RMC / VTG / ... / CUSTOM
+  char     text[NMEA_MAX_LINE];   // línea completa con *HH ("" = plantilla)
+  uint32_t intervalMs;
+};
+
+struct SlotTable { GenSlot slot[GEN_SLOTS]; };
+
+void   slotDefaults(SlotTable& t);
+// Aplica el lote sobre t (que trae el estado actual); false + err si algo no valida
+bool   slotsParse(const char* body, size_t n, SlotTable& t, char* err, size_t errCap);
+size_t slotsFormat(const SlotTable& t, char* out, size_t cap);
+
+// Un escritor (TaskNet) y un lector (TaskNMEA). El lector marca qué buffer
+// está leyendo; el escritor nunca toca ese buffer, así que nunca ve un slot a medio editar.
+template<typename T>
+class SwapBuffer {
+public:
+  SwapBuffer(){ front.store(0); reading.store(NONE); }
+
+  // ---- lector ----
+  const T& acquire(){
+    uint8_t i;
+    do { i=front.load(); reading.store(i); } while(front.load()!=i);
+    return buf[i];
+  }
+  void release(){ reading.store(NONE); }
+
+  // ---- escritor ----
+  const T& current() const { return buf[front.load()]; }
+  // Copia del actual para editar; espera si el lector sigue en el buffer de atrás
+  T& edit(){
+    uint8_t b=1-front.load();
+    while(reading.load()==b) spinWait();
+    buf[b]=buf[1-b];
+    return buf[b];
+  }
+  void publish(){ front.store(1-front.load()); }
+
+private:
+  static const uint8_t NONE=0xFF;
+  static void spinWait();
+  T buf[2];
+  std::atomic<uint8_t> front, reading;
+};
+
+#ifdef ARDUINO
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+template<typename T> void SwapBuffer<T>::spinWait(){ vTaskDelay(1); }
+#else
+#include <thread>
+template<typename T> void SwapBuffer<T>::spinWait(){ std::this_thread::yield(); }
+#endif
@@ -6,7 +6,16 @@
 #include <Adafruit_NeoPixel.h>
 #include <DNSServer.h>
 #include <Update.h>
+#include <Preferences.h>
 #include "esp_log.h"
+#include "nmea_core.h"
+#include "nmea_ring.h"
+#include "nmea_hal.h"
+#include "nmea_led.h"
+#include "nmea_ota.h"
+#include "nmea_config.h"
+#include "nmea_slots.h"
+#include "nmea_history.h"
 
 /* ==============================================================
    NMEA Link (ESP32 / ESP32-S3)  —  AP + Menú + Monitor + Generator + OTA
@@ -14,10 +23,13 @@
    • AP: SSID "NMEA_Link", pass "12345678" + captive redirect
    • Menú:  /  → Monitor / Generator / OTA
    • Monitor (RX=16)  arranca PAUSADO, Start/Pause, filtros, clear
+   • Historial (/history): decenas de miles de líneas en PSRAM,
+     búsqueda en el equipo por categoría/talker/formatter/texto/tiempo
    • Generator (TX=17) arranca PAUSADO, 4 slots editables, intervalos 0.1/0.5/1/2 s
+     (la página manda la tabla completa a /gen_slots, se publica de una vez)
    • UDP broadcast 10110 en red AP
    • LED NeoPixel 48: boot cian, RX ok verde, RX inválida rojo, TX azul
-   • Dos núcleos: TaskNet(core0) + TaskNMEA(core1)
+   • Dos núcleos: TaskNet+TaskLed(core0) + TaskNMEA(core1)
    • Serial: logs solo de arranque (no spam)
    ============================================================== */
 
@@ -40,10 +52,12 @@ DNSServer dnsServer;
 // ===== LED =====
 #define LED_PIN 48
 #define NUMPIXELS 1
-Adafruit_NeoPixel pixels(NUMPIXELS, LED_PIN, NEO_GRB + NEO_KHZ800);
-unsigned long ledMillis = 0;
+Adafruit_NeoPixel pixels(NUMPIXELS, LED_PIN, NEO_GRB + NEO_KHZ800);   // backend RMT en ESP32
 const int LED_DURATION = 50;
-bool ledOn = false;
+const int LED_FRAME_MS = 20;    // como mucho un refresh por frame
+LedMailbox   ledMailbox;
+LedScheduler ledSched(LED_DURATION);
+TaskHandle_t ledTask = NULL;
 
 // ===== UART =====
 HardwareSerial NMEA_Serial(1);
@@ -54,6 +68,7 @@ volatile int currentBaud = 4800;
 // ===== UDP =====
 WiFiUDP udp;
 IPAddress udpAddress;
+volatile bool netReady = false;   // el UART arranca antes que el AP: sin UDP hasta entonces
 const int udpPort = 10110;
 
 // ===== Web =====
@@ -61,176 +76,75 @@ WebServer server(80);
 
 // ===== Buffers =====
 #define BUFFER_LINES 50
-String nmeaBuffer[BUFFER_LINES];
-int bufferIndex = 0;
-String currentLine = "";
+LineRing<BUFFER_LINES, NMEA_MAX_LINE> nmeaBuffer;   // tag = NmeaCategory
 
 #define GEN_BUFFER_LINES 200
-String genBuffer[GEN_BUFFER_LINES];
-int genIndex = 0;
+LineRing<GEN_BUFFER_LINES, NMEA_MAX_LINE> genBuffer;
+
+// Historial de RX para buscar después; en PSRAM si hay, si no un bloque chico en RAM
+#define HIST_PSRAM_BYTES (4u*1024*1024)   // ~38k líneas
+#define HIST_RAM_BYTES   (32u*1024)       // ~300 líneas
+#define HIST_SEND_CHUNK  1460             // bytes de JSON por sendContent (~un segmento TCP)
+#define HIST_SCAN_CHUNK  1024             // registros por toma del mutex en una consulta
+NmeaHistory history;
 
 // ===== Estado app =====
 enum AppMode { MODE_MONITOR=0, MODE_GENERATOR=1 };
 volatile AppMode appMode = MODE_MONITOR;
 volatile bool monitorRunning   = false;  // arranca pausado
 volatile bool generatorRunning = false;  // arranca pausado
+volatile uint16_t monitorFilters = (1u<<NMEA_CAT_COUNT)-1;   // bit por NmeaCategory (filtros del Monitor)
 const int baudRates[4] = {4800,9600,38400,115200};
 
 // ===== Generator =====
-const int MAX_SLOTS = 4;
-struct GenSlot {
-  bool   enabled;
-  String sensor;     // GPS / WEATHER / HEADING / SOUNDER / VELOCITY / RADAR / TRANSDUCER / AIS / CUSTOM
-  String sentence;   // RMC / VTG / ...
-  String text;       // línea completa con *HH
-};
-GenSlot slots[MAX_SLOTS] = {
-  {true,  "GPS",      "RMC", ""},   // slot 0
-  {false, "GPS",      "VTG", ""},   // slot 1
-  {false, "VELOCITY", "VHW", ""},   // slot 2
-  {false, "HEADING",  "HDT", ""},   // slot 3
-};
-unsigned long slotInterval[MAX_SLOTS] = {500,500,500,500};
-unsigned long lastSentMs  [MAX_SLOTS] = {0,0,0,0};
+// TaskNet arma la tabla en el buffer de atrás y la publica entera;
+// TaskNMEA solo lee la publicada (nunca un slot a medio editar)
+SwapBuffer<SlotTable> slotTable;
+unsigned long lastSentMs[GEN_SLOTS] = {0,0,0,0};
 
 // ===== Sync =====
 SemaphoreHandle_t nmeaBufMutex;
 SemaphoreHandle_t genBufMutex;
 SemaphoreHandle_t serialMutex;
+SemaphoreHandle_t histMutex;
+
+// ===== Eventos TaskNMEA =====
+// TaskNMEA duerme en su notificación: la despiertan el UART (onReceive),
+// los handlers web que cambian estado y el timeout del próximo slot.
+TaskHandle_t nmeaTask = NULL;
+// 32 bits: se escribe en la task de eventos del UART y se lee en core 1 sin lock
+// (un uint64 puede leerse partido en Xtensa). Alcanza para latencias < 71 min.
+volatile uint32_t rxEventUs    = 0;   // última notificación del UART
+volatile uint32_t nmeaWakeups  = 0;
+volatile uint32_t rxLatencyUs  = 0;   // notificación → línea en ring + UDP (media móvil)
+volatile uint32_t rxLatencyMax = 0;
+volatile uint32_t rxOverflows  = 0;   // FIFO/buffer del UART desbordado (bytes perdidos)
+
+// En modo Monitor el UART se lee siempre (el historial graba aun en pausa);
+// Start/Pause solo decide consola en vivo, UDP y LED
+bool monitorListening(){ return appMode==MODE_MONITOR; }
+bool monitorActive(){ return monitorListening() && monitorRunning; }
+void wakeNMEA(){ if(nmeaTask) xTaskNotifyGive(nmeaTask); }
+// Corre en la task de eventos del UART. En pausa o en Generator no despierta a
+// TaskNMEA: los bytes quedan en el buffer del driver hasta reanudar.
+void onNmeaRx(){ rxEventUs=(uint32_t)halMicros(); if(monitorListening()) wakeNMEA(); }
+void onNmeaRxError(hardwareSerial_error_t e){ if(e==UART_FIFO_OVF_ERROR || e==UART_BUFFER_FULL_ERROR) rxOverflows++; }
 
 // ============ LED ============
-void flashLed(uint32_t color){
-  pixels.setPixelColor(0,color);
-  pixels.show();
-  ledOn = true;
-  ledMillis = millis();
-}
-void updateLed(){
-  if(ledOn && millis()-ledMillis>=LED_DURATION){
-    pixels.setPixelColor(0,0);
-    pixels.show();
-    ledOn=false;
-  }
+// Desde RX/TX solo se publica el evento; TaskLed (core 0, prioridad baja) hace el show()
+void flashLed(LedEvent e){
+  if(ledMailbox.post(e) && ledTask) xTaskNotifyGive(ledTask);
 }
 
 // ============ NMEA helpers ============
-bool processNMEA(const String &line){ return (line.startsWith("$")||line.startsWith("!")); }
-
-String detectSentenceType(const String &line){
-  if (line.startsWith("!")) return "AIS";
-  if (line.length()>=6 && line[0]=='$'){
-    String f = line.substring(3,6); f.toUpperCase();
-    if (f=="GLL"||f=="RMC"||f=="VTG"||f=="GGA"||f=="GSA"||f=="GSV"||f=="DTM"||f=="ZDA"||
-        f=="GNS"||f=="GST"||f=="GBS"||f=="GRS"||f=="RMB"||f=="RTE"||f=="BOD"||f=="XTE") return "GPS";
-    if (f=="DBT"||f=="DPT"||f=="DBK"||f=="DBS") return "SOUNDER";
-    if (f=="MWD"||f=="MWV"||f=="VWR"||f=="VWT"||f=="MTW"||f=="MTA"||f=="MMB"||f=="MHU"||f=="MDA") return "WEATHER";
-    if (f=="HDG"||f=="HDT"||f=="HDM"||f=="THS"||f=="ROT"||f=="RSA") return "HEADING";
-    if (f=="VHW"||f=="VLW"||f=="VBW") return "SPEED";
-    if (f=="TLL"||f=="TTM"||f=="TLB"||f=="OSD") return "RADAR";
-    if (f=="XDR") return "TRANSDUCER";
-  }
-  return "OTROS";
-}
-
-void sendUDP(const String &line){
+// Lógica pura en lib/NmeaCore (compila también en el env native)
+void sendUDP(const char* line, size_t n){
+  if(!netReady) return;
   udp.beginPacket(udpAddress, udpPort);
-  udp.print(line);
+  udp.write((const uint8_t*)line, n);
   udp.endPacket();
 }
-
-// ============ Builders / checksum ============
-String nmeaChecksum(const String &payload){
-  uint8_t cs=0; for(size_t i=0;i<payload.length();i++) cs^=(uint8_t)payload[i];
-  char b[3]; snprintf(b,sizeof(b),"%02X",cs); return String(b);
-}
-String buildDollarSentence(const String& talker,const String& code,const String& fields){
-  String payload = talker+code+","+fields;
-  return "$"+payload+"*"+nmeaChecksum(payload);
-}
-String buildAISSentence_VDM(){
-  String p="AIVDM,1,1,,A,13aG?P0P00PD;88MD5MT?wvl0<0,0";
-  return "!"+p+"*"+nmeaChecksum(p);
-}
-String buildAISSentence_VDO(){
-  String p="AIVDO,1,1,,A,13aG?P0P00PD;88MD5MT?wvl0<0,0";
-  return "!"+p+"*"+nmeaChecksum(p);
-}
-String talkerForSensor(const String& s){
-  if (s=="GPS") return "GP";
-  if (s=="AIS") return "AI";
-  if (s=="SOUNDER") return "SD";
-  if (s=="HEADING") return "HC";
-  if (s=="CUSTOM") return "";
-  return "II"; // WEATHER / VELOCITY / RADAR / TRANSDUCER
-}
-String generateSentence(const String& sensor,const String& codeIn){
-  if (sensor.equalsIgnoreCase("CUSTOM")||codeIn.equalsIgnoreCase("CUSTOM")) return "";
-  String c=codeIn; c.toUpperCase();
-  String t=talkerForSensor(sensor);
-
-  if(sensor=="AIS"){ if(c=="AIVDO") return buildAISSentence_VDO(); return buildAISSentence_VDM(); }
-
-  // GPS
-  if(sensor=="GPS"){
-    if(c=="RMC") return buildDollarSentence("GP",c,"123519,A,4807.038,N,01131.000,E,5.5,054.7,230394,003.1,W");
-    if(c=="GGA") return buildDollarSentence("GP",c,"123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
-    if(c=="GLL") return buildDollarSentence("GP",c,"4916.45,N,12311.12,W,225444,A");
-    if(c=="VTG") return buildDollarSentence("GP",c,"054.7,T,034.4,M,005.5,N,010.2,K");
-    if(c=="GSA") return buildDollarSentence("GP",c,"A,3,04,05,09,12,24,25,29,31,,,,,2.5,1.3,2.1");
-    if(c=="GSV") return buildDollarSentence("GP",c,"2,1,08,01,40,083,41,02,17,308,43,12,07,021,42,14,25,110,45");
-    if(c=="DTM") return buildDollarSentence("GP",c,"W84,,0.0,N,0.0,E,0.0,W84");
-    if(c=="ZDA") return buildDollarSentence("GP",c,"201530.00,04,07,2002,00,00");
-    if(c=="GNS") return buildDollarSentence("GN",c,"123519,4807.038,N,01131.000,E,AN,08,0.9,545.4,46.9,,");
-    if(c=="GST") return buildDollarSentence("GP",c,"123519,1.2,1.0,0.8,45.0,0.5,0.5,1.0");
-    if(c=="GBS") return buildDollarSentence("GP",c,"123519,0.5,0.5,0.8,01,0.75,0.00,1.00");
-    if(c=="GRS") return buildDollarSentence("GP",c,"123519,1,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0");
-    if(c=="RMB") return buildDollarSentence("GP",c,"A,0.66,L,ORIG,DEST,4916.45,N,12311.12,W,12.3,054.7,5.5,V");
-    if(c=="RTE") return buildDollarSentence("GP",c,"1,1,c,ROUTE1,WP1,WP2,WP3");
-    if(c=="BOD") return buildDollarSentence("GP",c,"045.0,T,023.0,M,DEST,ORIG");
-    if(c=="XTE") return buildDollarSentence("GP",c,"A,A,0.66,L,N");
-  }
-
-  // WEATHER
-  if(t=="II" && c=="MWD") return buildDollarSentence(t,c,"054.7,T,034.4,M,10.5,N,5.4,M");
-  if(t=="II" && c=="MWV") return buildDollarSentence(t,c,"054.7,R,10.5,N,A");
-  if(t=="II" && c=="VWR") return buildDollarSentence(t,c,"054.7,R,10.5,N,5.4,M,19.4,K");
-  if(t=="II" && c=="VWT") return buildDollarSentence(t,c,"054.7,T,10.5,N,5.4,M,19.4,K");
-  if(t=="II" && c=="MTW") return buildDollarSentence(t,c,"18.0,C");
-  if(t=="II" && c=="MTA") return buildDollarSentence(t,c,"19.5,C");
-  if(t=="II" && c=="MMB") return buildDollarSentence(t,c,"29.92,I");
-  if(t=="II" && c=="MHU") return buildDollarSentence(t,c,"45.0,P");
-  if(t=="II" && c=="MDA") return buildDollarSentence(t,c,"29.92,I,1.013,B,19.5,C,18.0,C,,");
-
-  // HEADING
-  if(t=="HC" && c=="HDG") return buildDollarSentence(t,c,"238.5,,E,0.5");
-  if(t=="HC" && c=="HDT") return buildDollarSentence(t,c,"238.5,T");
-  if(t=="HC" && c=="HDM") return buildDollarSentence(t,c,"236.9,M");
-  if(t=="HC" && c=="THS") return buildDollarSentence(t,c,"238.5,A");
-  if(t=="HC" && c=="ROT") return buildDollarSentence(t,c,"0.0,A");
-  if(t=="HC" && c=="RSA") return buildDollarSentence(t,c,"0.0,A,0.0,A");
-
-  // SOUNDER
-  if(t=="SD" && c=="DBT") return buildDollarSentence(t,c,"036.4,f,011.1,M,006.0,F");
-  if(t=="SD" && c=="DPT") return buildDollarSentence(t,c,"11.2,0.5");
-  if(t=="SD" && c=="DBK") return buildDollarSentence(t,c,"036.4,f,011.1,M,006.0,F");
-  if(t=="SD" && c=="DBS") return buildDollarSentence(t,c,"036.4,f,011.1,M,006.0,F");
-
-  // VELOCITY
-  if(t=="II" && c=="VHW") return buildDollarSentence(t,c,"054.7,T,034.4,M,5.5,N,10.2,K");
-  if(t=="II" && c=="VLW") return buildDollarSentence(t,c,"12.4,N,0.5,N");
-  if(t=="II" && c=="VBW") return buildDollarSentence(t,c,"5.5,0.1,0.0,5.3,0.1,0.0");
-
-  // RADAR
-  if(t=="II" && c=="TLL") return buildDollarSentence(t,c,"1,4916.45,N,12311.12,W,225444,TGT1");
-  if(t=="II" && c=="TTM") return buildDollarSentence(t,c,"1,2.5,N,054.7,T,0.0,N,054.7,T,0.0,54.7,TGT1");
-  if(t=="II" && c=="TLB") return buildDollarSentence(t,c,"1,LOCK,4916.45,N,12311.12,W,225444");
-  if(t=="II" && c=="OSD") return buildDollarSentence(t,c,"054.7,A,5.5,N,10.2,K");
-
-  // TRANSDUCER
-  if(t=="II" && c=="XDR") return buildDollarSentence(t,c,"C,19.5,C,AirTemp");
-
-  return buildDollarSentence(t,c,"");
-}
+void sendUDP(const String &line){ sendUDP(line.c_str(), line.length()); }
 
 // ============ HTML utils ============
 String htmlEscape(const String& s){
@@ -245,6 +159,9 @@ String htmlEscape(const String& s){
     else o += c;
   } return o;
 }
+void jsonEscape(String& o,const char* s){
+  for(;*s;s++){ if(*s=='"'||*s=='\\') o+='\\'; o+=*s; }   // el framer solo deja ASCII imprimible
+}
 String fullToEditable(const String& full){
   if(full.length()==0) return "";
   String s=full;
@@ -254,10 +171,9 @@ String fullToEditable(const String& full){
   if(star>=0) s=s.substring(0,star);
   return (ch?String(ch):String(""))+s;
 }
-void pushGen(const String& line){
+void pushGen(const char* line,size_t n){
   xSemaphoreTake(genBufMutex,portMAX_DELAY);
-  genIndex=(genIndex+1)%GEN_BUFFER_LINES;
-  genBuffer[genIndex]=line;
+  genBuffer.push(line,n);
   xSemaphoreGive(genBufMutex);
 }
 
@@ -265,12 +181,86 @@ void pushGen(const String& line){
 void startSerial(int baud){
   xSemaphoreTake(serialMutex,portMAX_DELAY);
   NMEA_Serial.end(); delay(5);
+  NMEA_Serial.onReceive(onNmeaRx);   // FIFO lleno o fin de ráfaga (RX timeout)
+  NMEA_Serial.onReceiveError(onNmeaRxError);
+  // Absorbe demoras de TaskNMEA; no las de flash: el ISR del UART no está en IRAM
+  // y mientras la caché está apagada solo queda el FIFO de 128 B (ver OTA)
+  NMEA_Serial.setRxBufferSize(1024);
   NMEA_Serial.begin(baud, SERIAL_8N1, RX_PIN, TX_PIN);
   while(NMEA_Serial.available()) (void)NMEA_Serial.read();
   currentBaud = baud;
   xSemaphoreGive(serialMutex);
 }
 
+// ============ Flash vs UART ============
+// Todo borrado+escritura de flash (OTA, NVS) apaga la caché en los dos núcleos ~45 ms
+// y el ISR del UART (no está en IRAM) no corre: solo el FIFO de 128 B guarda lo que llega.
+//   • <= 9600 baud el FIFO cubre un borrado (133 ms a 9600): sin pérdida.
+//   • Más rápido, antes de escribir se espera a que el bus quede en silencio
+//     (fin de ráfaga), hasta FLASH_GAP_MAX_MS.
+#define FLASH_GAP_MAX_MS 200
+#define RX_FIFO_EVENT    112   // bytes por evento de FIFO lleno (umbral del driver)
+
+// Silencio >= lo que tarda en llenarse un evento de FIFO → no hay ráfaga en curso.
+// false si se agotó la espera y se escribe igual
+bool waitBusGap(){
+  if(!monitorListening() || currentBaud<=9600) return true;
+  uint32_t quietUs=(uint32_t)((uint64_t)RX_FIFO_EVENT*10*1000000/currentBaud)+2000;
+  uint32_t t0=millis();
+  while((uint32_t)halMicros()-rxEventUs<quietUs){
+    if(millis()-t0>=FLASH_GAP_MAX_MS) return false;
+    vTaskDelay(1);
+  }
+  return true;
+}
+
+// ============ Config persistente ============
+// NVS "nmealink"/"cfg": blob versionado con CRC (lib/NmeaCore/nmea_config).
+// Los handlers solo marcan cambios; TaskNet guarda cuando la ráfaga de cambios termina,
+// y escribe en un silencio del bus NMEA (waitBusGap).
+Preferences prefs;
+SaveDebouncer configSave(1500, 10000);
+
+void configChanged(){ configSave.touch(millis()); }
+
+void snapshotConfig(NmeaConfig& c){
+  configDefaults(c);
+  c.baud=currentBaud; c.mode=(uint8_t)appMode;
+  c.slots=slotTable.current();
+  c.filterMask=monitorFilters; c.monRunning=monitorRunning; c.genRunning=generatorRunning;
+}
+void applyConfig(const NmeaConfig& c){
+  bool okBaud=false; for(int b:baudRates) okBaud|=(b==(int)c.baud);
+  currentBaud = okBaud? (int)c.baud : 4800;
+  appMode = (c.mode==MODE_GENERATOR)? MODE_GENERATOR : MODE_MONITOR;
+  SlotTable& t=slotTable.edit();
+  t=c.slots;
+  for(GenSlot& s:t.slot) if(s.intervalMs<GEN_MIN_INTERVAL) s.intervalMs=GEN_MIN_INTERVAL;
+  slotTable.publish();
+  monitorFilters=c.filterMask & ((1u<<NMEA_CAT_COUNT)-1); monitorRunning=c.monRunning; generatorRunning=c.genRunning;
+}
+// Antes de crear las tasks: sin blob válido quedan los defaults de siempre
+bool loadConfig(){
+  static uint8_t blob[CONFIG_MAX_BLOB];
+  static NmeaConfig c;
+  size_t n=0;
+  if(prefs.begin("nmealink",true)){ n=prefs.getBytes("cfg",blob,sizeof(blob)); prefs.end(); }
+  bool ok=configDecode(blob,n,c);
+  if(!ok) configDefaults(c);
+  applyConfig(c);
+  return ok;
+}
+void saveConfigIfDue(){
+  if(!configSave.due(millis())) return;
+  static uint8_t blob[CONFIG_MAX_BLOB];
+  static NmeaConfig c;
+  snapshotConfig(c);
+  size_t n=configEncode(c,blob,sizeof(blob));
+  if(n) waitBusGap();
+  if(n && prefs.begin("nmealink",false)){ prefs.putBytes("cfg",blob,n); prefs.end(); }
+  configSave.saved();
+}
+
 // ============ Web helpers ============
 void noCache(){
   server.sendHeader("Cache-Control","no-store, no-cache, must-revalidate, max-age=0");
@@ -301,20 +291,22 @@ void handleMenu(){
             "<h2 id='ttl'>NMEA Link</h2><div class='stack'>"
             "<button type='button' class='btn' id='b1' onclick='goMon()'>NMEA Monitor</button>"
             "<button type='button' class='btn' id='b2' onclick='goGen()'>NMEA Generator</button>"
+            "<button type='button' class='btn' id='b4' onclick='goHist()'>NMEA History</button>"
             "<button type='button' class='btn' id='b3' onclick='goOTA()'>OTA Update</button>"
             "</div><footer>© 2025 Matías Scuppa — by Themys</footer>");
 
   html +=
     "<script>"
     "let lang=localStorage.getItem('lang')||'en';"
-    "const L={en:{t:'NMEA Link',m:'NMEA Monitor',g:'NMEA Generator',o:'OTA Update'},"
-    "es:{t:'NMEA Link',m:'NMEA Monitor',g:'NMEA Generator',o:'Actualizar Firmware'},"
-    "fr:{t:'NMEA Link',m:'NMEA Monitor',g:'NMEA Generator',o:'Mise à jour OTA'}};"
+    "const L={en:{t:'NMEA Link',m:'NMEA Monitor',g:'NMEA Generator',h:'NMEA History',o:'OTA Update'},"
+    "es:{t:'NMEA Link',m:'NMEA Monitor',g:'NMEA Generator',h:'Historial NMEA',o:'Actualizar Firmware'},"
+    "fr:{t:'NMEA Link',m:'NMEA Monitor',g:'NMEA Generator',h:'Historique NMEA',o:'Mise à jour OTA'}};"
     "function setLang(l){lang=l;localStorage.setItem('lang',l);apply();}"
-    "function apply(){document.getElementById('ttl').innerText=L[lang].t;document.getElementById('b1').innerText=L[lang].m;document.getElementById('b2').innerText=L[lang].g;document.getElementById('b3').innerText=L[lang].o;document.getElementById('lang').value=lang;}"
+    "function apply(){document.getElementById('ttl').innerText=L[lang].t;document.getElementById('b1').innerText=L[lang].m;document.getElementById('b2').innerText=L[lang].g;document.getElementById('b3').innerText=L[lang].o;document.getElementById('b4').innerText=L[lang].h;document.getElementById('lang').value=lang;}"
     "async function goMon(){try{await fetch('/togglegen?state=0');await fetch('/setmonitor?state=0');await fetch('/setmode?m=monitor');}catch(e){} location.href='/monitor';}"
     "async function goGen(){try{await fetch('/togglegen?state=0');await fetch('/setmonitor?state=0');await fetch('/setmode?m=generator');}catch(e){} location.href='/generator';}"
-    "async function goOTA(){try{await fetch('/togglegen?state=0');await fetch('/setmonitor?state=0');}catch(e){} location.href='/update';}"
+    "function goOTA(){location.href='/update';}"
+    "function goHist(){location.href='/history';}"   // no pausa: el Monitor sigue grabando
     "document.addEventListener('DOMContentLoaded',apply);"
     "</script></body></html>";
 
@@ -338,7 +330,8 @@ void handleMonitor(){
   ".fbtn.active.OTROS{background:#aaa;color:#000}.OTROS{color:#aaa}footer{text-align:center;color:#666;font-size:12px;margin-top:10px}</style></head><body>");
 
   html += F("<select id='lang' class='lang' onchange='setLang(this.value)'><option value='en'>EN</option><option value='es'>ES</option><option value='fr'>FR</option></select>"
-            "<h2 id='title'>NMEA Reader</h2><div class='btnc' id='filterC'></div><div id='console'></div>");
+            "<h2 id='title'>NMEA Reader</h2><div class='btnc' id='filterC'></div><div id='console'></div>"
+            "<div id='stats' style='color:#666;font-size:12px;margin-top:4px'></div>");
 
   // baud
   html += "<div class='btnc'>";
@@ -359,7 +352,8 @@ void handleMonitor(){
           "<button type='button' class='btn' onclick='setSpeed(1,this)'>100%</button></div>";
 
   // nav
-  html += "<div class='btnc'><button type='button' class='btn' onclick='gotoGen()'>➡ NMEA Generator</button></div>"
+  html += "<div class='btnc'><button type='button' class='btn' onclick='gotoGen()'>➡ NMEA Generator</button>"
+          "<button type='button' class='btn' onclick=\"location.href='/history'\">🔎 History</button></div>"
           "<div class='btnc'><button type='button' class='btn' onclick='gotoMenu()'>🏠 Main Menu</button></div>"
           "<footer>© 2025 Matías Scuppa — by Themys</footer>";
 
@@ -376,7 +370,8 @@ void handleMonitor(){
     "let paused=true, intervalMs=1000, intervalId=null;"
     "function setLang(l){lang=l;localStorage.setItem('lang',l);applyLang();}"
     "function applyLang(){document.getElementById('pauseBtn').innerText=paused?Lb[lang].resume:Lb[lang].pause;document.getElementById('clearBtn').innerText=Lb[lang].clear;drawFilters();}"
-    "function drawFilters(){let c=document.getElementById('filterC');c.innerHTML='';filters.forEach(f=>{let b=document.createElement('button');b.type='button';b.className='fbtn '+f;if(filtersState[f])b.classList.add('active');b.innerText=cat[lang][f];b.onclick=()=>{filtersState[f]=!filtersState[f];b.classList.toggle('active',filtersState[f]);};c.appendChild(b);});let all=document.createElement('button');all.type='button';all.className='fbtn';all.innerText='ALL/NONE';all.onclick=()=>{let any=Object.values(filtersState).some(v=>v);Object.keys(filtersState).forEach(k=>filtersState[k]=!any);drawFilters();};c.appendChild(all);}"
+    "function drawFilters(){let c=document.getElementById('filterC');c.innerHTML='';filters.forEach(f=>{let b=document.createElement('button');b.type='button';b.className='fbtn '+f;if(filtersState[f])b.classList.add('active');b.innerText=cat[lang][f];b.onclick=()=>{filtersState[f]=!filtersState[f];b.classList.toggle('active',filtersState[f]);saveFilters();};c.appendChild(b);});let all=document.createElement('button');all.type='button';all.className='fbtn';all.innerText='ALL/NONE';all.onclick=()=>{let any=Object.values(filtersState).some(v=>v);Object.keys(filtersState).forEach(k=>filtersState[k]=!any);drawFilters();saveFilters();};c.appendChild(all);}"
+    "function saveFilters(){let m=0;filters.forEach((f,i)=>{if(filtersState[f])m|=1<<i;});fetch('/setfilters?mask='+m).catch(()=>{});}"
     "function togglePause(){paused=!paused;applyLang();fetch('/setmonitor?state='+(paused?0:1)).catch(()=>{});}"
     "function clearConsole(){document.getElementById('console').innerHTML='';fetch('/clearnmea').catch(()=>{});}"
     "async function setBaud(b){await fetch('/setbaud?baud='+b).catch(()=>{});document.querySelectorAll('.baud').forEach(x=>x.classList.remove('active'));let el=document.getElementById('baud_'+b);if(el)el.classList.add('active');}"
@@ -384,7 +379,10 @@ void handleMonitor(){
     "function poll(){if(paused)return;fetch('/getnmea?ts='+Date.now()).then(r=>r.text()).then(t=>{let c=document.getElementById('console');let lines=t.trim()?t.trim().split('\\n'):[];let visible=lines.filter(l=>{let lb=l.indexOf(']');let type=(lb>0&&l[0]=='[')?l.substring(1,lb):'OTROS';return filtersState[type];});c.innerHTML=visible.map(l=>{let lb=l.indexOf(']');let type=(lb>0&&l[0]=='[')?l.substring(1,lb):'OTROS';let disp=(cat[lang]&&cat[lang][type])?cat[lang][type]:type;let rest=(lb>=0)?l.substring(lb+1):l;return '<span class=\"'+type+'\">['+disp+']'+rest+'</span>';}).join('<br>');c.scrollTop=c.scrollHeight;}).catch(()=>{});}"
     "async function gotoGen(){paused=true;applyLang();try{await fetch('/setmonitor?state=0');await fetch('/setmode?m=generator');}catch(e){} location.href='/generator';}"
     "async function gotoMenu(){paused=true;try{await fetch('/setmonitor?state=0');await fetch('/togglegen?state=0');}catch(e){} location.href='/';}"
-    "document.addEventListener('DOMContentLoaded',()=>{fetch('/setmode?m=monitor');fetch('/setmonitor?state=0');applyLang();let b=document.getElementById('baud_"+String(currentBaud)+"');if(b)b.classList.add('active');intervalId=setInterval(poll,intervalMs);});"
+    "document.addEventListener('DOMContentLoaded',()=>{fetch('/setmode?m=monitor');fetch('/setmonitor?state=0');applyLang();let b=document.getElementById('baud_"+String(currentBaud)+"');if(b)b.classList.add('active');intervalId=setInterval(poll,intervalMs);"
+    "fetch('/getstatus').then(r=>r.json()).then(st=>{if(st.filters===undefined)return;filters.forEach((f,i)=>filtersState[f]=!!(st.filters&(1<<i)));drawFilters();}).catch(()=>{});});"
+    // Contadores de TaskNMEA (latencia evento UART → línea reenviada, despertares)
+    "function pollStats(){if(paused)return;fetch('/getstatus').then(r=>r.json()).then(st=>{document.getElementById('stats').textContent='RX lat '+st.rxLatUs+' µs (max '+st.rxLatMaxUs+' µs) · wakeups '+st.wakeups;}).catch(()=>{});} setInterval(pollStats,2000);"
     "window.addEventListener('beforeunload',()=>{if(intervalId)clearInterval(intervalId);});"
     "</script></body></html>";
 
@@ -407,50 +405,120 @@ String optionsForSensorSelect(const String& current){
     s += ">"; s += v; s += "</option>";
   } return s;
 }
+// Sentencias por sensor: alimenta los <select> y las tablas JS de la página
+static const char* const S_GPS[]={"GLL","RMC","VTG","GGA","GSA","GSV","DTM","ZDA","GNS","GST","GBS","GRS","RMB","RTE","BOD","XTE"};
+static const char* const S_WEATHER[]={"MWD","MWV","VWR","VWT","MTW","MTA","MMB","MHU","MDA"};
+static const char* const S_HEADING[]={"HDG","HDT","HDM","THS","ROT","RSA"};
+static const char* const S_SOUNDER[]={"DBT","DPT","DBK","DBS"};
+static const char* const S_VELOCITY[]={"VHW","VLW","VBW"};
+static const char* const S_RADAR[]={"TLL","TTM","TLB","OSD"};
+static const char* const S_TRANSDUCER[]={"XDR"};
+static const char* const S_AIS[]={"AIVDM","AIVDO"};
+struct SensorSentences { const char* sensor; const char* const* list; size_t n; };
+#define SENS(name,arr) {name,arr,sizeof(arr)/sizeof(arr[0])}
+static const SensorSentences SENSOR_SENTENCES[]={
+  SENS("GPS",S_GPS), SENS("WEATHER",S_WEATHER), SENS("HEADING",S_HEADING), SENS("SOUNDER",S_SOUNDER),
+  SENS("VELOCITY",S_VELOCITY), SENS("RADAR",S_RADAR), SENS("TRANSDUCER",S_TRANSDUCER), SENS("AIS",S_AIS),
+};
+#undef SENS
+
 String optionsForSentence(const String& sensor,const String& selected){
   String out;
-  if(sensor=="GPS"){
-    const char* arr[]={"GLL","RMC","VTG","GGA","GSA","GSV","DTM","ZDA","GNS","GST","GBS","GRS","RMB","RTE","BOD","XTE"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else if(sensor=="WEATHER"){
-    const char* arr[]={"MWD","MWV","VWR","VWT","MTW","MTA","MMB","MHU","MDA"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else if(sensor=="HEADING"){
-    const char* arr[]={"HDG","HDT","HDM","THS","ROT","RSA"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else if(sensor=="SOUNDER"){
-    const char* arr[]={"DBT","DPT","DBK","DBS"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else if(sensor=="VELOCITY"){
-    const char* arr[]={"VHW","VLW","VBW"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else if(sensor=="RADAR"){
-    const char* arr[]={"TLL","TTM","TLB","OSD"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else if(sensor=="TRANSDUCER"){
-    const char* arr[]={"XDR"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else if(sensor=="AIS"){
-    const char* arr[]={"AIVDM","AIVDO"};
-    for(size_t i=0;i<sizeof(arr)/sizeof(arr[0]);i++) appendOption(out,arr[i],selected);
-  } else {
-    appendOption(out,"CUSTOM",selected);
+  for(const SensorSentences& ss:SENSOR_SENTENCES){
+    if(sensor!=ss.sensor) continue;
+    for(size_t i=0;i<ss.n;i++) appendOption(out,ss.list[i],selected);
   }
   if(out.length()==0) appendOption(out,"CUSTOM",selected);
   return out;
 }
-String initialEditableForSlot(int i){
-  String full;
-  if(slots[i].text.length()) full=slots[i].text;
-  else {
-    if(slots[i].sensor=="CUSTOM"||slots[i].sentence=="CUSTOM"){
-      String payload="GPCUS,FIELD1,FIELD2";
-      full="$"+payload+"*"+nmeaChecksum(payload);
-    } else full=generateSentence(slots[i].sensor,slots[i].sentence);
+// {GPS:['GLL',...],...,CUSTOM:[]}
+String sentencesJs(){
+  String o="{";
+  for(const SensorSentences& ss:SENSOR_SENTENCES){
+    o += ss.sensor; o += ":[";
+    for(size_t i=0;i<ss.n;i++){ if(i) o += ","; o += "'"; o += ss.list[i]; o += "'"; }
+    o += "],";
   }
+  return o+"CUSTOM:[]}";
+}
+// {'GPS/RMC':'$GPRMC,...',...}: plantillas en forma editable, sin pedirlas al cambiar el select
+String templatesJs(){
+  String o="{"; char full[NMEA_MAX_LINE];
+  for(const SensorSentences& ss:SENSOR_SENTENCES)
+    for(size_t i=0;i<ss.n;i++){
+      if(!nmeaGenerate(full,sizeof(full),ss.sensor,ss.list[i])) continue;
+      o += "'"; o += ss.sensor; o += "/"; o += ss.list[i]; o += "':'"; o += fullToEditable(full); o += "',";
+    }
+  return o+"}";
+}
+String initialEditableForSlot(const GenSlot& s){
+  char full[NMEA_MAX_LINE];
+  if(s.text[0]) return htmlEscape(fullToEditable(s.text));
+  if(!strcmp(s.sensor,"CUSTOM")||!strcmp(s.sentence,"CUSTOM")) nmeaNormalize(full,sizeof(full),"GPCUS,FIELD1,FIELD2");
+  else nmeaGenerate(full,sizeof(full),s.sensor,s.sentence);
   return htmlEscape(fullToEditable(full));
 }
 
+// ============ HISTORIAL ============
+// Busca en el equipo sobre /gethistory; no toca modo ni Start/Pause del Monitor
+void handleHistory(){
+  String html = F("<!doctype html><html><head><meta charset='utf-8'><title>NMEA History</title>"
+  "<meta name='viewport' content='width=device-width, initial-scale=1.0'>"
+  "<style>body{font-family:monospace;background:#000;color:#0f0;margin:0;padding:10px}"
+  "h2{text-align:center;color:#0ff;margin:8px 0}"
+  ".row{display:flex;gap:6px;flex-wrap:wrap;margin:6px 0}.row>*{flex:1;min-width:120px}"
+  "select,input{box-sizing:border-box;padding:6px;background:#111;color:#0f0;border:1px solid #0f0;border-radius:6px}"
+  ".btn{padding:10px;background:#111;color:#0f0;border:1px solid #0f0;border-radius:8px;font-size:16px;cursor:pointer;text-align:center}"
+  ".btn:disabled{color:#444;border-color:#333}"
+  "#out{width:100%;box-sizing:border-box;height:55vh;overflow:auto;border:1px solid #0f0;padding:5px;font-size:13px;white-space:pre-wrap;overflow-wrap:anywhere}"
+  "#info{color:#666;font-size:12px;margin:4px 0}"
+  ".GPS{color:#0ff}.AIS{color:#ff0}.SOUNDER{color:#0f0}.SPEED{color:#f0f}.HEADING{color:#1e90ff}.RADAR{color:#ff4500}"
+  ".WEATHER{color:#7fffd4}.TRANSDUCER{color:#ffa500}.OTROS{color:#aaa}"
+  "footer{text-align:center;color:#666;font-size:12px;margin-top:10px}</style></head><body>");
+
+  html += "<h2 id='ttl'>NMEA History</h2>"
+          "<div class='row'><select id='cat'><option value=''>ALL</option>";
+  for(int i=0;i<NMEA_CAT_COUNT;i++){
+    html += "<option value='"+String(1<<i)+"'>"; html += nmeaCategoryName((NmeaCategory)i); html += "</option>";
+  }
+  html += "</select>"
+          "<input id='talker' maxlength='2' placeholder='Talker (GP)' autocomplete='off'>"
+          "<input id='fmt' maxlength='3' placeholder='Formatter (RMC)' autocomplete='off'></div>"
+          "<div class='row'><input id='q' placeholder='Text' autocomplete='off'>"
+          "<select id='win'><option value='60000'>1 min</option><option value='600000' selected>10 min</option>"
+          "<option value='3600000'>1 h</option><option value='0'>∞</option></select></div>"
+          "<div class='row'><button type='button' id='goBtn' class='btn' onclick='search(false)'>🔎 Search</button>"
+          "<button type='button' id='moreBtn' class='btn' onclick='search(true)' disabled>⏬ More</button></div>"
+          "<div id='info'></div><div id='out'></div>"
+          "<div class='row'><button type='button' id='clrBtn' class='btn' onclick='clearHist()'>🧹 Clear history</button>"
+          "<button type='button' id='backBtn' class='btn' onclick=\"location.href='/'\">🏠 Main Menu</button></div>"
+          "<footer>© 2025 Matías Scuppa — by Themys</footer>";
+
+  html +=
+    "<script>"
+    "let lang=localStorage.getItem('lang')||'en';"
+    "const L={en:{t:'NMEA History',go:'🔎 Search',more:'⏬ More',clr:'🧹 Clear history',back:'🏠 Main Menu',q:'Text',found:'found',scanned:'scanned',stored:'stored'},"
+    "es:{t:'Historial NMEA',go:'🔎 Buscar',more:'⏬ Más',clr:'🧹 Borrar historial',back:'🏠 Menú principal',q:'Texto',found:'encontradas',scanned:'revisadas',stored:'guardadas'},"
+    "fr:{t:'Historique NMEA',go:'🔎 Rechercher',more:'⏬ Plus',clr:'🧹 Effacer l’historique',back:'🏠 Menu principal',q:'Texte',found:'trouvées',scanned:'parcourues',stored:'stockées'}};"
+    "let cursor=null,found=0,scanned=0;"
+    "function $(id){return document.getElementById(id);}"
+    "function age(ms){let s=ms/1000;if(s<60)return '-'+s.toFixed(1)+'s';let m=Math.floor(s/60);if(m<60)return '-'+m+'m'+Math.floor(s%60)+'s';return '-'+Math.floor(m/60)+'h'+(m%60)+'m';}"
+    "function params(){const p=new URLSearchParams();if($('cat').value)p.set('cat',$('cat').value);"
+    "['talker','fmt','q'].forEach(k=>{const v=$(k).value.trim();if(v)p.set(k,v);});"
+    "if(+$('win').value>0)p.set('since',$('win').value);p.set('limit','200');return p;}"
+    "async function search(more){const p=params();if(more&&cursor!==null)p.set('cursor',cursor);else{$('out').innerHTML='';found=0;scanned=0;}"
+    "try{const j=await(await fetch('/gethistory?'+p)).json();const out=$('out');"
+    "j.items.forEach(it=>{const d=document.createElement('div');d.className=it[2];d.textContent=age(j.now-it[1])+' ['+it[2]+'] '+it[3];out.appendChild(d);});"
+    "found+=j.items.length;scanned+=j.scanned;cursor=j.next;$('moreBtn').disabled=!j.more;"
+    "$('info').textContent=found+' '+L[lang].found+' · '+scanned+' '+L[lang].scanned+' · '+(j.end-j.first)+'/'+j.cap+' '+L[lang].stored;}catch(e){}}"
+    "function clearHist(){fetch('/clearhistory').then(()=>{$('out').innerHTML='';$('info').textContent='';cursor=null;$('moreBtn').disabled=true;}).catch(()=>{});}"
+    "function applyLang(){$('ttl').innerText=L[lang].t;$('goBtn').innerText=L[lang].go;$('moreBtn').innerText=L[lang].more;$('clrBtn').innerText=L[lang].clr;$('backBtn').innerText=L[lang].back;$('q').placeholder=L[lang].q;}"
+    "document.addEventListener('DOMContentLoaded',()=>{applyLang();$('q').addEventListener('keydown',e=>{if(e.key==='Enter')search(false);});});"
+    "</script></body></html>";
+
+  noCache(); server.send(200,"text/html; charset=utf-8",html);
+}
+
 // ============ GENERATOR ============
 void handleGenerator(){
   String html = F("<!doctype html><html><head><meta charset='utf-8'><title>NMEA Generator</title>"
@@ -470,6 +538,7 @@ void handleGenerator(){
   ".btn{padding:10px;background:#111;color:#0f0;border:1px solid #0f0;border-radius:8px;font-size:16px;cursor:pointer;text-align:center}"
   ".btn.small{padding:6px 8px;font-size:14px;border-radius:6px}"
   ".btn.active{background:#0f0;color:#000;font-weight:bold}"
+  "#slotErr{color:#f44;margin-top:8px;white-space:pre-wrap}"
   "#genconsole{width:100%;box-sizing:border-box;height:40vh;overflow:auto;border:1px solid #0f0;padding:5px;background:#000;margin-top:10px}"
   ".btn-row{display:flex;gap:6px;margin-top:10px;align-items:stretch}"
   ".btn-row .start{flex:2}"
@@ -480,24 +549,28 @@ void handleGenerator(){
   "</style></head><body>");
 
   html += "<h2 id='genTitle'>NMEA Generator</h2><div class='grid' id='slots'>";
-  for(int i=0;i<MAX_SLOTS;i++){
-    unsigned long ms=slotInterval[i];
+  const SlotTable& table=slotTable.current();
+  String intervals;
+  for(int i=0;i<GEN_SLOTS;i++){
+    const GenSlot& s=table.slot[i];
+    unsigned long ms=s.intervalMs;
+    intervals += (i? ",":"") + String(ms);
     bool a100=(ms==100),a500=(ms==500),a1000=(ms==1000),a2000=(ms==2000);
     html += "<div class='card' id='slot_"+String(i)+"'>";
 
     // Fila alineada con columnas a la izquierda
     html += "  <div class='row'>";
     html += "    <div class='col'>";
-    html += "      <label class='label-inline'><input type='checkbox' id='en_"+String(i)+"'"+(slots[i].enabled?" checked":"")+"><span class='lblSensor'>Sensor</span></label>";
-    html += "      <select id='sensor_"+String(i)+"'>"+optionsForSensorSelect(slots[i].sensor)+"</select>";
+    html += "      <label class='label-inline'><input type='checkbox' id='en_"+String(i)+"'"+(s.enabled?" checked":"")+"><span class='lblSensor'>Sensor</span></label>";
+    html += "      <select id='sensor_"+String(i)+"'>"+optionsForSensorSelect(s.sensor)+"</select>";
     html += "    </div>";
     html += "    <div class='col'>";
     html += "      <label class='lblSentence'>Sentence type</label>";
-    html += "      <select id='sentence_"+String(i)+"'>"+optionsForSentence(slots[i].sensor,slots[i].sentence)+"</select>";
+    html += "      <select id='sentence_"+String(i)+"'>"+optionsForSentence(s.sensor,s.sentence)+"</select>";
     html += "    </div>";
     html += "  </div>";
 
-    html += "  <div class='row spaceTop'><div style='flex:1 1 100%'><input id='text_"+String(i)+"' placeholder='$GPRMC,...' autocomplete='off' value='"+initialEditableForSlot(i)+"'></div></div>";
+    html += "  <div class='row spaceTop'><div style='flex:1 1 100%'><input id='text_"+String(i)+"' maxlength='"+String(GEN_TEXT_MAX)+"' placeholder='$GPRMC,...' autocomplete='off' value='"+initialEditableForSlot(s)+"'></div></div>";
 
     html += "  <div class='row spaceTop'><div style='flex:1 1 100%'><label class='lblIntervalSlot'>Interval</label><div id='intgrp_"+String(i)+"' class='row' style='gap:8px'>";
     html += String("    <button type='button' class='btn small int-btn") + (a100? " active" : "") + "' onclick='setIntervalSlot(" + String(i) + ",100,this)'>0.1s</button>";
@@ -508,7 +581,7 @@ void handleGenerator(){
 
     html += "</div>";
   }
-  html += "</div>";
+  html += "</div><div id='slotErr'></div>";
 
   // baud
   html += "<label id='lblBaud'>Baudrate</label><div class='row'>";
@@ -527,31 +600,45 @@ void handleGenerator(){
 
   html +=
     "<script>"
-    "const sentencesBySensor={GPS:['GLL','RMC','VTG','GGA','GSA','GSV','DTM','ZDA','GNS','GST','GBS','GRS','RMB','RTE','BOD','XTE'],"
-    "WEATHER:['MWD','MWV','VWR','VWT','MTW','MTA','MMB','MHU','MDA'],HEADING:['HDG','HDT','HDM','THS','ROT','RSA'],"
-    "SOUNDER:['DBT','DPT','DBK','DBS'],VELOCITY:['VHW','VLW','VBW'],RADAR:['TLL','TTM','TLB','OSD'],TRANSDUCER:['XDR'],AIS:['AIVDM','AIVDO'],CUSTOM:[]};"
+    "const sentencesBySensor="+sentencesJs()+";"
+    "const TPL="+templatesJs()+";"
+    "const ivl=["+intervals+"];"
     "let lang=localStorage.getItem('lang')||'en';"
     "const L={en:{title:'NMEA Generator',sensor:'Sensor',sentenceSel:'Sentence type',sentenceInline:'Sentence',interval:'Interval',start:'▶ Start',pause:'⏸ Pause',clear:'🧹 Clear',back:'⬅ NMEA Monitor',baud:'Baudrate'},"
     "es:{title:'NMEA Generator',sensor:'Sensor',sentenceSel:'Tipo de sentencia',sentenceInline:'Sentencia',interval:'Intervalo',start:'▶ Iniciar',pause:'⏸ Pausar',clear:'🧹 Limpiar',back:'⬅ NMEA Monitor',baud:'Baudrate'},"
     "fr:{title:'NMEA Generator',sensor:'Capteur',sentenceSel:'Type de trame',sentenceInline:'Trame',interval:'Intervalle',start:'▶ Démarrer',pause:'⏸ Pause',clear:'🧹 Effacer',back:'⬅ NMEA Monitor',baud:'Baudrate'}};"
 
-    "function hex2(n){return n.toString(16).toUpperCase().padStart(2,'0');}"
-    "function csPayload(s){let cs=0;for(let i=0;i<s.length;i++){cs^=s.charCodeAt(i);}return hex2(cs);} "
-    "function buildFullFromEditor(str){ if(!str) return ''; str=str.trim(); let ch=null; if(str[0]==='$'||str[0]==='!'){ ch=str[0]; str=str.slice(1);} let up=str.toUpperCase(); if(!ch) ch=(up.startsWith('AIVDM')||up.startsWith('AIVDO'))?'!':'$'; let payload=str; return ch+payload+'*'+csPayload(payload);} "
 
     "function refillSent(sensorSel,sentSel){sentSel.innerHTML='';const arr=sentencesBySensor[sensorSel.value]||[];if(arr.length===0){let o=document.createElement('option');o.value='CUSTOM';o.text='CUSTOM';sentSel.appendChild(o);}else{for(let i=0;i<arr.length;i++){let o=document.createElement('option');o.value=arr[i];o.text=arr[i];sentSel.appendChild(o);}}}"
 
     "async function getStatus(){try{const r=await fetch('/getstatus');return await r.json();}catch(e){return {baud:4800,genRunning:false};}}"
 
+    // Toda la tabla en un solo POST (el servidor normaliza el texto y recalcula *HH)
+    "function slotLine(i){const sen=document.getElementById('sensor_'+i).value;return i+'|'+(document.getElementById('en_'+i).checked?1:0)+'|'+sen+'|'+document.getElementById('sentence_'+i).value+'|'+ivl[i]+'|'+document.getElementById('text_'+i).value;}"
+    "function slotsBody(){let b='';for(let i=0;i<ivl.length;i++)b+=slotLine(i)+'\\n';return b;}"
+    "let pushT=null;"
+    // Si el lote se rechaza (o no llega) se muestra el motivo y se vuelve a lo que tiene el equipo
+    "function applySlots(t){t.split('\\n').forEach(l=>{const f=l.split('|');if(f.length<6)return;const i=+f[0];if(!(i>=0&&i<ivl.length))return;"
+    "document.getElementById('en_'+i).checked=f[1]==='1';const se=document.getElementById('sensor_'+i),sn=document.getElementById('sentence_'+i);se.value=f[2];refillSent(se,sn);sn.value=f[3];"
+    "ivl[i]=+f[4];const g=document.getElementById('intgrp_'+i);if(g)g.querySelectorAll('.int-btn').forEach(b=>b.classList.toggle('active',Math.round(parseFloat(b.innerText)*1000)===ivl[i]));"
+    "const x=f.slice(5).join('|');document.getElementById('text_'+i).value=x?x.replace(/^[$!]/,'').replace(/\\*.*$/,''):tplFor(f[2],f[3]);});}"
+    "function resyncSlots(){fetch('/gen_slots').then(r=>r.ok?r.text():'').then(t=>{if(t)applySlots(t);}).catch(()=>{});}"
+    "function slotErr(t){document.getElementById('slotErr').textContent=t;}"
+    "function pushSlots(ms){clearTimeout(pushT);pushT=setTimeout(()=>{pushT=null;fetch('/gen_slots',{method:'POST',headers:{'Content-Type':'text/plain'},body:slotsBody()})"
+    ".then(async r=>{if(r.ok){slotErr('');return;}slotErr('⚠ '+(await r.text()));resyncSlots();})"
+    ".catch(()=>{slotErr('⚠ not saved (no connection)');resyncSlots();});},ms);}"
+    "window.addEventListener('pagehide',()=>{if(pushT){clearTimeout(pushT);pushT=null;navigator.sendBeacon('/gen_slots',slotsBody());}});"
+    "function tplFor(sensor,sent){return TPL[sensor+'/'+sent]||'$GPCUS,FIELD1,FIELD2';}"
+
     "function initSlot(i){const en=document.getElementById('en_'+i),sensorSel=document.getElementById('sensor_'+i),sentSel=document.getElementById('sentence_'+i),txt=document.getElementById('text_'+i);"
-    " en.addEventListener('change',e=>{fetch('/gen_slot_enable?i='+i+'&en='+(e.target.checked?1:0)).catch(()=>{});});"
-    " sensorSel.addEventListener('change',async ()=>{refillSent(sensorSel,sentSel);const newSent=sentSel.value;try{await fetch('/gen_slot_sensor?i='+i+'&sensor='+sensorSel.value);await fetch('/gen_slot_sentence?i='+i+'&sentence='+newSent);const r=await fetch('/gen_slot_template?i='+i);const t=await r.text();const ch=(t&&(t[0]==='$'||t[0]==='!'))?t[0]:'';let s=t? t.slice(ch?1:0):'';let star=s.indexOf('*'); if(star>=0) s=s.slice(0,star);txt.value=(ch?s?ch+s:s:s);}catch(e){}});"
-    " sentSel.addEventListener('change',async ()=>{try{await fetch('/gen_slot_sentence?i='+i+'&sentence='+sentSel.value);const r=await fetch('/gen_slot_template?i='+i);const t=await r.text();const ch=(t&&(t[0]==='$'||t[0]==='!'))?t[0]:'';let s=t? t.slice(ch?1:0):'';let star=s.indexOf('*'); if(star>=0) s=s.slice(0,star);txt.value=(ch?s?ch+s:s:s);}catch(e){}});"
-    " txt.addEventListener('input',e=>{ if(e.target.value.indexOf('*')>=0){ e.target.value=e.target.value.replace(/\\*/g,''); } const full=buildFullFromEditor(e.target.value); fetch('/gen_slot_text',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'i='+i+'&text='+encodeURIComponent(full)}).catch(()=>{});});"
+    " en.addEventListener('change',()=>pushSlots(0));"
+    " sensorSel.addEventListener('change',()=>{refillSent(sensorSel,sentSel);if(sensorSel.value!=='CUSTOM'||!txt.value)txt.value=tplFor(sensorSel.value,sentSel.value);pushSlots(0);});"
+    " sentSel.addEventListener('change',()=>{txt.value=tplFor(sensorSel.value,sentSel.value);pushSlots(0);});"
+    " txt.addEventListener('input',e=>{ if(e.target.value.indexOf('*')>=0){ e.target.value=e.target.value.replace(/\\*/g,''); } pushSlots(400);});"
     "}"
 
     "function setActive(sel,scope,el){(scope||document).querySelectorAll(sel).forEach(b=>b.classList.remove('active')); if(el) el.classList.add('active');}"
-    "function setIntervalSlot(i,ms,btn){fetch('/gen_slot_interval?i='+i+'&ms='+ms).then(()=>{const g=document.getElementById('intgrp_'+i);if(!g)return;setActive('.int-btn',g,btn);}).catch(()=>{});} "
+    "function setIntervalSlot(i,ms,btn){ivl[i]=ms;const g=document.getElementById('intgrp_'+i);if(g)setActive('.int-btn',g,btn);pushSlots(0);} "
     "async function setGenBaud(b,btn){try{await fetch('/setbaud?baud='+b);setActive('.gen-baud',document,btn);}catch(e){}}"
 
     "let running=false;"
@@ -560,7 +647,7 @@ void handleGenerator(){
     "function pollGen(){fetch('/getgen?ts='+Date.now()).then(r=>r.text()).then(t=>{let c=document.getElementById('genconsole');c.innerHTML=(t||'').split('\\n').join('<br>');c.scrollTop=c.scrollHeight;}).catch(()=>{});} setInterval(pollGen,300);"
     "function applyLang(){document.getElementById('genTitle').innerText=L[lang].title;document.getElementById('startBtn').innerText=running?L[lang].pause:L[lang].start;document.getElementById('clearBtn').innerText=L[lang].clear;document.getElementById('lblBaud').innerText=L[lang].baud;document.querySelectorAll('.lblSensor').forEach(e=>e.innerText=L[lang].sensor);document.querySelectorAll('.lblSentence').forEach(e=>e.innerText=L[lang].sentenceSel);document.querySelectorAll('.lblIntervalSlot').forEach(e=>e.innerText=L[lang].interval);}"
     "document.addEventListener('DOMContentLoaded',async()=>{fetch('/setmode?m=generator');lang=localStorage.getItem('lang')||'en';for(let i=0;i<"
-    + String(MAX_SLOTS) +
+    + String(GEN_SLOTS) +
     ";i++){initSlot(i);}const st=await getStatus();running=!!st.genRunning;applyLang();var b=document.getElementById('gen_baud_'+(st.baud||4800));if(b)b.classList.add('active');});"
     "</script><footer>© 2025 Matías Scuppa — by Themys</footer></body></html>";
 
@@ -568,17 +655,51 @@ void handleGenerator(){
 }
 
 // ============ OTA ============
+// Update escribe en TaskNet (core 0); Monitor/Generator siguen en core 1. El write
+// que cierra un sector espera un silencio del bus (ver Flash vs UART): buses con
+// pausas entre ráfagas no pierden nada; uno saturado sí, y queda contado en
+// rxOverflows / gapsForced.
+class UpdateSink : public OtaSink {
+public:
+  bool   begin(size_t size) override { return Update.begin(size?size:UPDATE_SIZE_UNKNOWN); }
+  size_t write(const uint8_t* d, size_t n) override { return Update.write((uint8_t*)d,n); }
+  bool   end() override { return Update.end(true); }
+  void   abort() override { Update.abort(); }
+  const char* error() override { return Update.errorString(); }
+};
+UpdateSink  updateSink;
+OtaPipeline ota(updateSink);
+const size_t FLASH_SECTOR = 4096;
+uint32_t otaGapsForced=0, otaOverflows0=0;
+
+String otaStatusJson(){
+  static const char* ST[]={"idle","receiving","ok","failed"};
+  String json="{";
+  json += "\"state\":\""+String(ST[ota.state()])+"\",";
+  json += "\"bytes\":"+String((unsigned long)ota.received())+",";
+  json += "\"size\":"+String((unsigned long)ota.expected())+",";
+  json += "\"bps\":"+String(ota.bytesPerSec(millis()))+",";
+  json += "\"verified\":"; json += (ota.verified()?"true":"false"); json += ",";
+  json += "\"sha256\":\""+String(ota.digestHex())+"\",";
+  json += "\"gapsForced\":"+String(otaGapsForced)+",";
+  json += "\"rxOverflows\":"+String(rxOverflows-otaOverflows0)+",";
+  json += "\"error\":\""+String(ota.error())+"\"";
+  json += "}";
+  return json;
+}
+
 void handleUpdatePage(){
-  generatorRunning=false; monitorRunning=false;
   String html = F("<!doctype html><html><head><meta charset='utf-8'><title>OTA Update</title>"
   "<meta name='viewport' content='width=device-width, initial-scale=1.0'>"
   "<style>body{font-family:monospace;background:#000;color:#0f0;margin:0;padding:10px}h2{text-align:center;color:#0ff;margin:8px 0}"
   ".card{border:1px solid #0f0;border-radius:8px;padding:12px;background:#000;margin-top:10px}"
-  "input[type=file]{width:100%;box-sizing:border-box;padding:8px;background:#111;color:#0f0;border:1px solid #0f0;border-radius:8px}"
+  "input{width:100%;box-sizing:border-box;padding:8px;background:#111;color:#0f0;border:1px solid #0f0;border-radius:8px;margin-top:6px}"
+  "progress{width:100%;margin-top:8px;accent-color:#0f0}"
   ".btn{padding:10px;background:#111;color:#0f0;border:1px solid #0f0;border-radius:8px;font-size:16px;cursor:pointer;text-align:center;display:inline-block;margin-top:8px}.btn-full{width:100%;display:block}"
-  "#status{margin-top:8px;color:#7fffd4}footer{text-align:center;color:#666;font-size:12px;margin-top:10px}</style></head><body>");
+  "#status{margin-top:8px;color:#7fffd4;word-break:break-all}footer{text-align:center;color:#666;font-size:12px;margin-top:10px}</style></head><body>");
   html += "<h2 id='ttl'>OTA Update</h2><div class='card'><p id='msg'>Select the firmware .bin file and upload. The device will reboot automatically.</p>"
-          "<input id='file' type='file' accept='.bin'><button type='button' class='btn btn-full' id='btnUp' onclick='doUpload()'>Upload</button><div id='status'></div></div>"
+          "<input id='file' type='file' accept='.bin'><input id='sha' placeholder='sha256sum of the .bin (optional)' autocomplete='off'>"
+          "<button type='button' class='btn btn-full' id='btnUp' onclick='doUpload()'>Upload</button><progress id='prog' max='100' value='0'></progress><div id='status'></div></div>"
           "<div class='card'><a class='btn btn-full' href='/' id='btnMenu'>🏠 Main Menu</a></div>";
   html +=
     "<script>"
@@ -586,135 +707,301 @@ void handleUpdatePage(){
     "es:{title:'Actualizar Firmware',msg:'Selecciona el archivo .bin y súbelo. El equipo se reiniciará automáticamente.',upload:'Subir',menu:'🏠 Menú Principal',ok:'Subida OK. Reiniciando…',fail:'Fallo en la subida.'},"
     "fr:{title:'Mise à jour OTA',msg:'Sélectionnez le fichier .bin et téléversez-le. L’appareil redémarrera automatiquement.',upload:'Téléverser',menu:'🏠 Menu Principal',ok:'Téléversement OK. Redémarrage…',fail:'Échec du téléversement.'}};"
     "function apply(){document.getElementById('ttl').innerText=T[lang].title;document.getElementById('msg').innerText=T[lang].msg;document.getElementById('btnUp').innerText=T[lang].upload;document.getElementById('btnMenu').innerText=T[lang].menu;}apply();"
-    "async function doUpload(){const f=document.getElementById('file').files[0];if(!f){document.getElementById('status').innerText='No file';return;}const fd=new FormData();fd.append('update',f,f.name);document.getElementById('status').innerText='Uploading…';try{const r=await fetch('/update',{method:'POST',body:fd});const t=await r.text();if(t.trim()==='OK'){document.getElementById('status').innerText=T[lang].ok;setTimeout(()=>{location.href='/'},8000);}else{document.getElementById('status').innerText=T[lang].fail+' ('+t+')';}}catch(e){document.getElementById('status').innerText=T[lang].fail;}}"
+    "function st(t){document.getElementById('status').innerText=t;}"
+    // El equipo siempre verifica el SHA-256 embebido en la imagen; el pegado es un chequeo extra
+    "function doUpload(){const f=document.getElementById('file').files[0];if(!f){st('No file');return;}"
+    "const sha=document.getElementById('sha').value.trim();"
+    "const fd=new FormData();fd.append('update',f,f.name);const x=new XMLHttpRequest();const t0=Date.now();"
+    "x.upload.onprogress=e=>{if(!e.lengthComputable)return;const p=Math.round(e.loaded*100/e.total);document.getElementById('prog').value=p;st(p+'%  '+Math.round(e.loaded/Math.max(1,Date.now()-t0))+' kB/s');};"
+    "x.onload=()=>{let r={};try{r=JSON.parse(x.responseText);}catch(e){}if(r.state==='ok'){st(T[lang].ok+'\\nSHA-256 '+r.sha256+(r.verified?' ✔':'')+'\\n'+r.bytes+' B @ '+r.bps+' B/s · RX overflows '+r.rxOverflows);setTimeout(()=>{location.href='/'},8000);}else{st(T[lang].fail+' ('+(r.error||x.responseText)+')');}};"
+    "x.onerror=()=>st(T[lang].fail);"
+    "x.open('POST','/update?size='+f.size+'&sha256='+encodeURIComponent(sha));x.send(fd);}"
     "</script><footer>© 2025 Matías Scuppa — by Themys</footer></body></html>";
   noCache(); server.send(200,"text/html; charset=utf-8",html);
 }
 void handleUpdateUpload(){
   HTTPUpload& up=server.upload();
   if(up.status==UPLOAD_FILE_START){
-    generatorRunning=false; monitorRunning=false;
-    Update.begin(UPDATE_SIZE_UNKNOWN);
+    size_t size=server.hasArg("size")? (size_t)server.arg("size").toInt() : 0;
+    otaGapsForced=0; otaOverflows0=rxOverflows;
+    ota.begin(size, server.arg("sha256").c_str(), millis());
   } else if(up.status==UPLOAD_FILE_WRITE){
-    Update.write(up.buf, up.currentSize);
+    // Update borra/escribe cuando su buffer de un sector se llena: este write cierra uno
+    size_t at=ota.received();
+    if(at/FLASH_SECTOR != (at+up.currentSize)/FLASH_SECTOR && !waitBusGap()) otaGapsForced++;
+    ota.write(up.buf, up.currentSize, millis());
   } else if(up.status==UPLOAD_FILE_END){
-    Update.end(true);
+    ota.finish(millis());
+  } else if(up.status==UPLOAD_FILE_ABORTED){
+    ota.abort("upload aborted");
   }
 }
+void handleUpdateDone(){
+  bool ok=(ota.state()==OTA_OK);
+  noCache(); server.sendHeader("Connection","close");
+  server.send(ok?200:500,"application/json",otaStatusJson());
+  if(ok){ delay(800); ESP.restart(); }
+}
 
 // ============ API Monitor/Gen ============
-void handleToggleGen(){ if(server.hasArg("state")) generatorRunning = (server.arg("state")=="1"); noCache(); server.send(200,"text/plain",generatorRunning?"RUNNING":"STOPPED"); }
+void handleToggleGen(){
+  bool was=generatorRunning;
+  if(server.hasArg("state")) generatorRunning = (server.arg("state")=="1");
+  if(generatorRunning!=was){ wakeNMEA(); configChanged(); }
+  noCache(); server.send(200,"text/plain",generatorRunning?"RUNNING":"STOPPED"); }
 void handleGetGen(){
   String out;
   xSemaphoreTake(genBufMutex,portMAX_DELAY);
-  for(int i=0;i<GEN_BUFFER_LINES;i++){ int idx=(genIndex+i)%GEN_BUFFER_LINES; if(genBuffer[idx].length()>0) out+=genBuffer[idx]+"\n"; }
+  out.reserve(genBuffer.size()*64);
+  genBuffer.forEach([&](const char* l,size_t,uint8_t){ out+=l; out+='\n'; });
   xSemaphoreGive(genBufMutex);
   noCache(); server.send(200,"text/plain",out);
 }
-void handleClearGen(){ xSemaphoreTake(genBufMutex,portMAX_DELAY); for(int i=0;i<GEN_BUFFER_LINES;i++) genBuffer[i]=""; genIndex=0; xSemaphoreGive(genBufMutex); noCache(); server.send(200,"text/plain","OK"); }
-void handleSetMode(){ String m=server.hasArg("m")?server.arg("m"):"monitor"; appMode=(m=="generator")?MODE_GENERATOR:MODE_MONITOR; generatorRunning=false; monitorRunning=false; noCache(); server.send(200,"text/plain",(appMode==MODE_GENERATOR)?"GENERATOR":"MONITOR"); }
-void handleSetMonitor(){ if(server.hasArg("state")) monitorRunning=(server.arg("state")=="1"); noCache(); server.send(200,"text/plain",monitorRunning?"RUNNING":"PAUSED"); }
+void handleClearGen(){ xSemaphoreTake(genBufMutex,portMAX_DELAY); genBuffer.clear(); xSemaphoreGive(genBufMutex); noCache(); server.send(200,"text/plain","OK"); }
+void handleSetMode(){
+  String m=server.hasArg("m")?server.arg("m"):"monitor";
+  AppMode mode=(m=="generator")?MODE_GENERATOR:MODE_MONITOR;
+  // Recargar la página vuelve a pedir el modo: si no cambia nada, no se pausa ni se guarda
+  if(mode!=appMode || generatorRunning || monitorRunning){
+    appMode=mode; generatorRunning=false; monitorRunning=false;
+    wakeNMEA(); configChanged();
+  }
+  noCache(); server.send(200,"text/plain",(appMode==MODE_GENERATOR)?"GENERATOR":"MONITOR"); }
+void handleSetMonitor(){
+  bool was=monitorRunning;
+  if(server.hasArg("state")) monitorRunning=(server.arg("state")=="1");
+  if(monitorRunning!=was){ wakeNMEA(); configChanged(); }
+  noCache(); server.send(200,"text/plain",monitorRunning?"RUNNING":"PAUSED"); }
 void handleGetNMEA(){
   String out; xSemaphoreTake(nmeaBufMutex,portMAX_DELAY);
-  for(int i=0;i<BUFFER_LINES;i++){ int idx=(bufferIndex+i)%BUFFER_LINES; if(nmeaBuffer[idx].length()>0) out+=nmeaBuffer[idx]+"\n"; }
+  out.reserve(nmeaBuffer.size()*80);
+  nmeaBuffer.forEach([&](const char* l,size_t,uint8_t tag){ out+='['; out+=nmeaCategoryName((NmeaCategory)tag); out+="] "; out+=l; out+='\n'; });
   xSemaphoreGive(nmeaBufMutex);
   noCache(); server.send(200,"text/plain",out);
 }
-void handleSetBaud(){ noCache(); if(server.hasArg("baud")){ int b=server.arg("baud").toInt(); if(b==4800||b==9600||b==38400||b==115200) startSerial(b); server.send(200,"text/plain","OK"); } else server.send(400,"text/plain","Error"); }
-void handleClearNMEA(){ xSemaphoreTake(nmeaBufMutex,portMAX_DELAY); for(int i=0;i<BUFFER_LINES;i++) nmeaBuffer[i]=""; bufferIndex=0; currentLine=""; xSemaphoreGive(nmeaBufMutex); noCache(); server.send(200,"text/plain","OK"); }
-
-int argIndex(){ if(!server.hasArg("i")) return -1; int i=server.arg("i").toInt(); if(i<0||i>=MAX_SLOTS) return -1; return i; }
-void handleGenSlotEnable(){ int i=argIndex(); if(i<0){server.send(400,"text/plain","Bad slot");return;} bool en=server.hasArg("en")&&(server.arg("en").toInt()==1); slots[i].enabled=en; server.send(200,"text/plain",en?"1":"0"); }
-void handleGenSlotSensor(){ int i=argIndex(); if(i<0){server.send(400,"text/plain","Bad slot");return;} if(server.hasArg("sensor")){ slots[i].sensor=server.arg("sensor"); if(slots[i].sensor=="CUSTOM") slots[i].sentence="CUSTOM"; } server.send(200,"text/plain",slots[i].sensor); }
-void handleGenSlotSentence(){ int i=argIndex(); if(i<0){server.send(400,"text/plain","Bad slot");return;} if(server.hasArg("sentence")) slots[i].sentence=server.arg("sentence"); server.send(200,"text/plain",slots[i].sentence); }
-void handleGenSlotText_POST(){ int i=-1; if(server.hasArg("i")) i=server.arg("i").toInt(); if(i<0||i>=MAX_SLOTS){server.send(400,"text/plain","Bad slot");return;} String incoming=server.hasArg("text")?server.arg("text"):""; slots[i].text=incoming; server.send(200,"text/plain",incoming); }
-void handleGenSlotText_GET(){ int i=argIndex(); if(i<0){server.send(400,"text/plain","Bad slot");return;} String incoming=server.hasArg("text")?server.arg("text"):""; slots[i].text=incoming; server.send(200,"text/plain",incoming); }
-void handleGenSlotTemplate(){ int i=argIndex(); if(i<0){server.send(400,"text/plain","Bad slot");return;} String t; if(slots[i].sensor=="CUSTOM"||slots[i].sentence=="CUSTOM"){ t=slots[i].text.length()?slots[i].text:"$GPCUS,FIELD1,FIELD2*00"; if(t.startsWith("$")||t.startsWith("!")){ int star=t.indexOf('*'); String payload=(star>=0)?t.substring(1,star):t.substring(1); t=String(t[0])+payload+"*"+nmeaChecksum(payload);} else { String up=t; up.toUpperCase(); char ch=(up.startsWith("AIVDM")||up.startsWith("AIVDO"))?'!':'$'; String payload=t; t=String(ch)+payload+"*"+nmeaChecksum(payload);} } else { t=generateSentence(slots[i].sensor,slots[i].sentence); } slots[i].text=t; server.send(200,"text/plain",t); }
-void handleGenSlotInterval(){ int i=argIndex(); if(i<0){server.send(400,"text/plain","Bad slot");return;} if(!server.hasArg("ms")){server.send(400,"text/plain","Missing ms");return;} long ms=server.arg("ms").toInt(); if(ms<50) ms=50; slotInterval[i]=(unsigned long)ms; server.send(200,"text/plain",String(slotInterval[i])); }
+void handleSetBaud(){ noCache(); if(server.hasArg("baud")){ int b=server.arg("baud").toInt(); if(b==4800||b==9600||b==38400||b==115200){ startSerial(b); configChanged(); } server.send(200,"text/plain","OK"); } else server.send(400,"text/plain","Error"); }
+void handleSetFilters(){ noCache(); if(!server.hasArg("mask")){ server.send(400,"text/plain","Missing mask"); return; } monitorFilters=(uint16_t)(server.arg("mask").toInt() & ((1<<NMEA_CAT_COUNT)-1)); configChanged(); server.send(200,"text/plain",String(monitorFilters)); }
+static String u64(uint64_t v){ char b[24]; snprintf(b,sizeof(b),"%llu",(unsigned long long)v); return String(b); }
+
+// /gethistory?cat=mask&talker=GP&fmt=RMC&q=texto&since=ms | from=ms&to=ms &cursor=seq&limit=n&order=asc
+// Por defecto las más nuevas primero (cursor = límite superior, excluido); order=asc
+// recorre de la más vieja hacia adelante (cursor = próxima a mirar).
+// Recorre por tramos de HIST_SCAN_CHUNK soltando el mutex entre tramos: TaskNMEA nunca
+// espera una consulta entera. Lo pisado mientras tanto se saltea (cursor < firstSeq).
+// La respuesta sale chunked de a HIST_SEND_CHUNK, siempre con el mutex suelto.
+void handleGetHistory(){
+  HistQuery q;
+  if(server.hasArg("cat"))    q.catMask=(uint16_t)server.arg("cat").toInt();
+  if(server.hasArg("talker")) q.talker=histTalker(server.arg("talker").c_str());
+  if(server.hasArg("fmt"))    q.formatter=histFormatter(server.arg("fmt").c_str());
+  String text=server.arg("q");
+  q.contains=text.c_str();
+  size_t limit=server.hasArg("limit")? (size_t)server.arg("limit").toInt() : 200;
+  if(limit<1) limit=1;
+  if(limit>500) limit=500;
+  bool asc=(server.arg("order")=="asc");
+
+  uint32_t now=millis();
+  xSemaphoreTake(histMutex,portMAX_DELAY);
+  uint64_t first=history.firstSeq(), lo=first, hi=history.endSeq(), stored=hi;
+  if(server.hasArg("since"))     lo=history.seqAt(now-(uint32_t)server.arg("since").toInt());
+  else if(server.hasArg("from")) lo=history.seqAt((uint32_t)server.arg("from").toInt());
+  if(server.hasArg("to"))        hi=history.seqAt((uint32_t)server.arg("to").toInt()+1);
+  xSemaphoreGive(histMutex);
+  if(server.hasArg("cursor")){
+    uint64_t c=strtoull(server.arg("cursor").c_str(),nullptr,10);
+    if(asc){ if(c>lo) lo=c; } else if(c<hi) hi=c;
+  }
+
+  String chunk; chunk.reserve(HIST_SEND_CHUNK+HIST_TEXT*2+64);
+  chunk += "{\"now\":"+String(now)+",\"first\":"+u64(first)+",\"end\":"+u64(stored);
+  chunk += ",\"cap\":"+String((unsigned)history.capacity())+",\"items\":[";
+  noCache();
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200,"application/json","");
+
+  size_t found=0, scanned=0;
+  auto add=[&](uint64_t seq,const HistEntry& e,const char* t){
+    if(found) chunk+=',';
+    chunk+='['; chunk+=u64(seq); chunk+=','; chunk+=String(e.ms); chunk+=",\"";
+    chunk+=nmeaCategoryName((NmeaCategory)e.cat); chunk+="\",\""; jsonEscape(chunk,t); chunk+="\"]";
+    return ++found<limit && chunk.length()<HIST_SEND_CHUNK;
+  };
+  while(found<limit && lo<hi){
+    xSemaphoreTake(histMutex,portMAX_DELAY);
+    if(lo<history.firstSeq()) lo=history.firstSeq();   // pisadas mientras se paginaba
+    if(hi<lo) hi=lo;
+    uint64_t a=lo, b=hi;
+    if(asc) lo=history.scan(q,lo,hi,HIST_SCAN_CHUNK,add);
+    else    hi=history.scanBack(q,lo,hi,HIST_SCAN_CHUNK,add);
+    scanned+=(size_t)((lo-a)+(b-hi));
+    xSemaphoreGive(histMutex);
+    if(chunk.length()>=HIST_SEND_CHUNK){ server.sendContent(chunk); chunk=""; }
+  }
+
+  chunk += "],\"scanned\":"+String((unsigned)scanned);
+  chunk += ",\"next\":"+u64(asc? lo : hi)+",\"more\":"; chunk += (lo<hi)?"true":"false";
+  chunk += "}";
+  server.sendContent(chunk);
+  server.sendContent("");   // fin del chunked
+}
+void handleClearHistory(){ xSemaphoreTake(histMutex,portMAX_DELAY); history.clear(); xSemaphoreGive(histMutex); noCache(); server.send(200,"text/plain","OK"); }
+void handleClearNMEA(){ xSemaphoreTake(nmeaBufMutex,portMAX_DELAY); nmeaBuffer.clear(); xSemaphoreGive(nmeaBufMutex); noCache(); server.send(200,"text/plain","OK"); }
+
+// Lote de slots: se valida entero sobre el buffer de atrás y se publica de una vez
+void handleGenSlotsGet(){
+  static char body[GEN_SLOTS*(NMEA_MAX_LINE+40)];
+  slotsFormat(slotTable.current(),body,sizeof(body));
+  noCache(); server.send(200,"text/plain",body);
+}
+void handleGenSlotsPost(){
+  String body=server.arg("plain");
+  char err[64];
+  if(!slotsParse(body.c_str(),body.length(),slotTable.edit(),err,sizeof(err))){ server.send(400,"text/plain",err); return; }
+  slotTable.publish();
+  wakeNMEA(); configChanged();
+  handleGenSlotsGet();
+}
 void handleGetStatus(){
   String json="{";
   json += "\"mode\":\""+String(appMode==MODE_GENERATOR?"generator":"monitor")+"\",";
   json += "\"baud\":"+String(currentBaud)+",";
   json += "\"genRunning\":"; json += (generatorRunning?"true":"false"); json += ",";
-  json += "\"monRunning\":"; json += (monitorRunning?"true":"false");
+  json += "\"monRunning\":"; json += (monitorRunning?"true":"false"); json += ",";
+  json += "\"filters\":"+String(monitorFilters)+",";
+  json += "\"wakeups\":"+String(nmeaWakeups)+",";
+  json += "\"rxLatUs\":"+String(rxLatencyUs)+",";
+  json += "\"rxLatMaxUs\":"+String(rxLatencyMax)+",";
+  json += "\"rxOverflows\":"+String(rxOverflows)+",";
+  xSemaphoreTake(histMutex,portMAX_DELAY);
+  json += "\"histSize\":"+String((unsigned)history.size())+",";
+  json += "\"histCap\":"+String((unsigned)history.capacity());
+  xSemaphoreGive(histMutex);
   json += "}";
   noCache(); server.send(200,"application/json",json);
 }
 
 // ============ Tasks ============
+void TaskLed(void*){
+  for(;;){
+    if(ledSched.step(ledMailbox.take(),millis())){
+      pixels.setPixelColor(0,ledSched.color());
+      pixels.show();
+    }
+    uint32_t off=ledSched.msUntilOff(millis());
+    // Solo se junta un frame si llegó un evento; el timeout de apagado se procesa
+    // enseguida, así el hold sigue siendo de 50 ms y no 50 + LED_FRAME_MS
+    if(ulTaskNotifyTake(pdTRUE, off==UINT32_MAX? portMAX_DELAY : pdMS_TO_TICKS(off)+1))
+      vTaskDelay(pdMS_TO_TICKS(LED_FRAME_MS));
+  }
+}
 void TaskNet(void*){
   for(;;){
     dnsServer.processNextRequest();
     server.handleClient();
+    saveConfigIfDue();
     vTaskDelay(1);
   }
 }
 void TaskNMEA(void*){
+  static NmeaFramer framer;   // CR o LF cierran la línea
+  bool wasActive=false;
   for(;;){
     // MONITOR
-    if(appMode==MODE_MONITOR && monitorRunning){
+    bool active=monitorActive();
+    if(active && !wasActive){
+      // Al reanudar, lo que quedó en el buffer se mide desde ahora y no desde
+      // el último evento de antes de la pausa (inflaría rxLatencyMax)
+      rxEventUs=(uint32_t)halMicros(); rxLatencyUs=0; rxLatencyMax=0;
+    }
+    wasActive=active;
+    if(monitorListening()){
       xSemaphoreTake(serialMutex,portMAX_DELAY);
       while(NMEA_Serial.available()){
-        char c=(char)NMEA_Serial.read();
+        if(!framer.push((char)NMEA_Serial.read())) continue;
 
-        // CR o LF cierran la línea
-        if(c=='\n' || c=='\r'){
-          if(currentLine.length()==0) continue;
+        xSemaphoreGive(serialMutex);
 
-          xSemaphoreGive(serialMutex);
+        const char* line=framer.line();
+        size_t n=framer.length();
+        NmeaCategory cat=nmeaClassify(line,n);
 
-          String line=currentLine;
-          currentLine="";
-          line.trim();
+        xSemaphoreTake(histMutex,portMAX_DELAY);
+        history.push(line,n,cat,millis());
+        xSemaphoreGive(histMutex);
 
-          if(line.length()==0){ xSemaphoreTake(serialMutex,portMAX_DELAY); continue; }
-
-          bool valid=processNMEA(line);
-          flashLed(valid?pixels.Color(0,255,0):pixels.Color(255,0,0));
-
-          String type=detectSentenceType(line);
-          String formatted="["+type+"] "+line;
+        if(active){   // en pausa solo el historial
+          bool valid=nmeaIsSentence(line,n);
+          flashLed(valid?LED_RX_OK:LED_RX_BAD);
 
           xSemaphoreTake(nmeaBufMutex,portMAX_DELAY);
-          bufferIndex=(bufferIndex+1)%BUFFER_LINES;
-          nmeaBuffer[bufferIndex]=formatted;
+          nmeaBuffer.push(line,n,cat);
           xSemaphoreGive(nmeaBufMutex);
 
-          if(valid) sendUDP(line);
+          if(valid) sendUDP(line,n);
 
-          xSemaphoreTake(serialMutex,portMAX_DELAY);
-        }
-        else if(c>=32 && c<=126){
-          currentLine+=c;
+          uint32_t lat=(uint32_t)halMicros()-rxEventUs;
+          rxLatencyUs=(rxLatencyUs*7+lat)/8;
+          if(lat>rxLatencyMax) rxLatencyMax=lat;
         }
+
+        xSemaphoreTake(serialMutex,portMAX_DELAY);
       }
       xSemaphoreGive(serialMutex);
     }
 
-    // GENERATOR
+    // GENERATOR: envía lo vencido y calcula cuánto dormir hasta el próximo slot
+    TickType_t wait=portMAX_DELAY;
     if(appMode==MODE_GENERATOR && generatorRunning){
       unsigned long now=millis();
-      for(int i=0;i<MAX_SLOTS;i++){
-        if(!slots[i].enabled) continue;
-        if(now-lastSentMs[i] >= slotInterval[i]){
+      // Copia lo vencido con la tabla tomada y la suelta antes de tocar UART/UDP
+      char out[GEN_SLOTS][NMEA_MAX_LINE]; size_t len[GEN_SLOTS]; int nOut=0;
+      const SlotTable& t=slotTable.acquire();
+      for(int i=0;i<GEN_SLOTS;i++){
+        const GenSlot& s=t.slot[i];
+        if(!s.enabled) continue;
+        if(now-lastSentMs[i] >= s.intervalMs){
           lastSentMs[i]=now;
-          String out = slots[i].text.length()?slots[i].text:generateSentence(slots[i].sensor,slots[i].sentence);
-          if(out.length()==0) continue;
-          xSemaphoreTake(serialMutex,portMAX_DELAY);
-          NMEA_Serial.println(out);
-          xSemaphoreGive(serialMutex);
-          sendUDP(out);
-          pushGen(out);
-          flashLed(pixels.Color(0,0,255)); // TX azul
+          size_t n;
+          if(s.text[0]){ n=strnlen(s.text,NMEA_MAX_LINE-1); memcpy(out[nOut],s.text,n); out[nOut][n]=0; }
+          else n=nmeaGenerate(out[nOut],NMEA_MAX_LINE,s.sensor,s.sentence);
+          if(n) len[nOut++]=n;
         }
+        TickType_t due=pdMS_TO_TICKS(s.intervalMs-(now-lastSentMs[i]));
+        if(due<1) due=1;
+        if(due<wait) wait=due;
+      }
+      slotTable.release();
+
+      for(int k=0;k<nOut;k++){
+        xSemaphoreTake(serialMutex,portMAX_DELAY);
+        NMEA_Serial.println(out[k]);
+        xSemaphoreGive(serialMutex);
+        sendUDP(out[k],len[k]);
+        pushGen(out[k],len[k]);
+        flashLed(LED_TX);
       }
     }
 
-    updateLed();
-    vTaskDelay(1);
+    // Sin polling: UART, handlers web o el próximo slot
+    ulTaskNotifyTake(pdTRUE, wait);
+    nmeaWakeups++;
   }
 }
 
+// ============ Historial ============
+void historyBegin(){
+  size_t bytes=0; void* mem=nullptr;
+  if(psramFound()){
+    bytes=ESP.getMaxAllocPsram()/4*3;
+    if(bytes>HIST_PSRAM_BYTES) bytes=HIST_PSRAM_BYTES;
+    mem=ps_malloc(bytes);
+  }
+  if(!mem){ bytes=HIST_RAM_BYTES; mem=malloc(bytes); }
+  history.begin(mem,bytes);
+  DPRINTF("Historial: %u lineas (%s)\n",(unsigned)history.capacity(),psramFound()?"PSRAM":"RAM");
+}
+
 // ============ Setup/Loop ============
 void setup(){
   Serial.begin(115200);
@@ -722,10 +1009,20 @@ void setup(){
   esp_log_level_set("*", ESP_LOG_NONE);
 
   pixels.begin(); pixels.show();
+  xTaskCreatePinnedToCore(TaskLed, "TaskLed", 2048, NULL, 1, &ledTask, 0);
+  flashLed(LED_BOOT);
 
   nmeaBufMutex=xSemaphoreCreateMutex();
   genBufMutex =xSemaphoreCreateMutex();
   serialMutex =xSemaphoreCreateMutex();
+  histMutex   =xSemaphoreCreateMutex();
+  historyBegin();
+
+  bool cfgOk=loadConfig();   // slots/baud/modo/filtros antes de abrir el UART y crear tasks
+
+  // El enlace serie no espera a la red: Monitor/Generator corren mientras sube el AP
+  startSerial(currentBaud);
+  xTaskCreatePinnedToCore(TaskNMEA, "TaskNMEA", 6144, NULL, 2, &nmeaTask, 1);
 
   WiFi.mode(WIFI_AP);
   WiFi.softAP(AP_SSID, AP_PASSWORD);
@@ -734,10 +1031,8 @@ void setup(){
   dnsServer.start(DNS_PORT, "*", apIP);
   MDNS.begin("nmeareader"); MDNS.addService("http","tcp",80);
 
-  flashLed(pixels.Color(0,255,255)); // boot
-  startSerial(currentBaud);
-
   udpAddress = apIP; udpAddress[3]=255; // broadcast 192.168.4.255
+  netReady = true;
 
   // Captive helpers
   server.on("/generate_204", handleCaptive);
@@ -753,10 +1048,7 @@ void setup(){
   server.on("/monitor",   handleMonitor);
   server.on("/generator", handleGenerator);
   server.on("/update",    HTTP_GET, handleUpdatePage);
-  server.on("/update",    HTTP_POST,
-    [](){ noCache(); server.sendHeader("Connection","close"); server.send(200,"text/plain",Update.hasError()?"FAIL":"OK"); delay(800); ESP.restart(); },
-    handleUpdateUpload
-  );
+  server.on("/update",    HTTP_POST, handleUpdateDone, handleUpdateUpload);
 
   // API comunes
   server.on("/getnmea",   handleGetNMEA);
@@ -764,19 +1056,18 @@ void setup(){
   server.on("/setmode",   handleSetMode);
   server.on("/setmonitor",handleSetMonitor);
   server.on("/clearnmea", handleClearNMEA);
+  server.on("/setfilters",handleSetFilters);
+  server.on("/history",   handleHistory);
+  server.on("/gethistory",handleGetHistory);
+  server.on("/clearhistory",handleClearHistory);
 
   // API generator
   server.on("/togglegen",        handleToggleGen);
   server.on("/getgen",           handleGetGen);
   server.on("/cleargen",         handleClearGen);
   server.on("/getstatus",        handleGetStatus);
-  server.on("/gen_slot_enable",  handleGenSlotEnable);
-  server.on("/gen_slot_sensor",  handleGenSlotSensor);
-  server.on("/gen_slot_sentence",handleGenSlotSentence);
-  server.on("/gen_slot_template",handleGenSlotTemplate);
-  server.on("/gen_slot_text",    HTTP_POST, handleGenSlotText_POST);
-  server.on("/gen_slot_text",    HTTP_GET,  handleGenSlotText_GET);
-  server.on("/gen_slot_interval",handleGenSlotInterval);
+  server.on("/gen_slots", HTTP_GET,  handleGenSlotsGet);
+  server.on("/gen_slots", HTTP_POST, handleGenSlotsPost);
 
   // NotFound → redirigir a menú
   server.onNotFound([](){
@@ -793,11 +1084,11 @@ void setup(){
   Serial.print( "📄 IP (AP): " ); Serial.println(apIP.toString());
   Serial.print( "🌐 UDP broadcast: " ); Serial.print(udpAddress.toString()); Serial.print(":"); Serial.println(udpPort);
   Serial.printf("🔧 UART RX=%d  TX=%d  baud=%d\n", RX_PIN, TX_PIN, currentBaud);
+  Serial.println(cfgOk? "💾 Config restaurada (NVS)" : "💾 Config por defecto");
   Serial.println("✅ HTTP server + DNS (captive) listos");
-  Serial.println("🧵 Tasks: Net(core0) + NMEA(core1)");
+  Serial.println("🧵 Tasks: Net+LED(core0) + NMEA(core1)");
 
   xTaskCreatePinnedToCore(TaskNet,  "TaskNet",  4096, NULL, 1, NULL, 0);
-  xTaskCreatePinnedToCore(TaskNMEA, "TaskNMEA", 6144, NULL, 2, NULL, 1);
 }
 
 void loop(){ /* vacío (todo corre en tasks) */ }
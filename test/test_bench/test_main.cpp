@@ -0,0 +1,166 @@
+#include <unity.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "nmea_core.h"
+#include "nmea_ring.h"
+#include "nmea_hal.h"
+#include "nmea_history.h"
+
+/* ==============================================================
+   Benchmark del núcleo NMEA (host)
+   ---------------------------------------------------------------
+   • Reproduce cada .nmea de test/corpus por el mismo camino que el
+     Monitor: framer → validar → clasificar → ring + historial.
+   • Reporta ns/sentencia y allocs/sentencia; falla si el camino
+     caliente vuelve a tocar el heap.
+   • Consultas al historial: ns/registro filtrando solo por índice
+     y con substring (el caso que lee el texto).
+   • NMEA_CORPUS_DIR cambia el directorio del corpus.
+   • -D NMEA_BENCH_MAX_NS=<n> convierte el tiempo en gate de CI.
+   ============================================================== */
+
+#ifndef NMEA_BENCH_REPS
+#define NMEA_BENCH_REPS 200
+#endif
+
+// ===== Contador de allocations =====
+static volatile size_t allocs=0;
+void* operator new(size_t n){ allocs++; if(void* p=malloc(n?n:1)) return p; throw std::bad_alloc(); }
+void* operator new[](size_t n){ allocs++; if(void* p=malloc(n?n:1)) return p; throw std::bad_alloc(); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+struct BenchResult { size_t sentences; size_t allocs; double nsPerSentence; double allocsPerSentence; };
+
+static std::vector<std::string> corpusFiles(){
+  const char* dir=getenv("NMEA_CORPUS_DIR"); if(!dir) dir="test/corpus";
+  std::vector<std::string> out;
+  if(DIR* d=opendir(dir)){
+    while(dirent* e=readdir(d)){
+      std::string n=e->d_name;
+      if(n.size()>5 && n.compare(n.size()-5,5,".nmea")==0) out.push_back(std::string(dir)+"/"+n);
+    }
+    closedir(d);
+  }
+  std::sort(out.begin(),out.end());
+  return out;
+}
+
+static std::vector<char> loadFile(const std::string& path){
+  std::vector<char> b;
+  if(FILE* f=fopen(path.c_str(),"rb")){
+    char tmp[4096]; size_t n;
+    while((n=fread(tmp,1,sizeof(tmp),f))>0) b.insert(b.end(),tmp,tmp+n);
+    fclose(f);
+  }
+  return b;
+}
+
+static LineRing<50, NMEA_MAX_LINE> ring;
+static const size_t HIST_RECS=32768;   // orden de lo que entra en PSRAM
+static NmeaHistory history;
+static volatile uint32_t sink;
+
+static BenchResult replay(const std::vector<char>& data){
+  NmeaFramer framer; size_t sentences=0; uint32_t valid=0;
+  size_t a0=allocs; uint64_t t0=halMicros();
+  for(int rep=0;rep<NMEA_BENCH_REPS;rep++){
+    for(char c:data){
+      if(!framer.push(c)) continue;
+      const char* l=framer.line(); size_t n=framer.length();
+      valid+=nmeaIsSentence(l,n);
+      NmeaCategory cat=nmeaClassify(l,n);
+      ring.push(l,n,cat);
+      history.push(l,n,cat,(uint32_t)sentences);
+      sentences++;
+    }
+  }
+  uint64_t us=halMicros()-t0; size_t da=allocs-a0;
+  sink=valid;
+  BenchResult r{sentences/NMEA_BENCH_REPS,da,0,0};
+  if(sentences){ r.nsPerSentence=us*1000.0/sentences; r.allocsPerSentence=(double)da/sentences; }
+  return r;
+}
+
+static void historyBench(const char* name, const HistQuery& q){
+  const int reps=20;
+  size_t matched=0; uint64_t t0=halMicros();
+  for(int rep=0;rep<reps;rep++)
+    history.scan(q,history.firstSeq(),history.endSeq(),SIZE_MAX,[&](uint64_t,const HistEntry&,const char*){ matched++; return true; });
+  uint64_t us=halMicros()-t0;
+  sink=(uint32_t)matched;
+  char msg[160];
+  snprintf(msg,sizeof(msg),"history %-18s %6zu records  %6.2f ns/record  %zu matches",
+           name,history.size(),us*1000.0/((double)reps*history.size()),matched/reps);
+  TEST_MESSAGE(msg);
+}
+
+void setUp(){}
+void tearDown(){}
+
+void test_corpus_replay(){
+  std::vector<std::string> files=corpusFiles();
+  TEST_ASSERT_TRUE_MESSAGE(!files.empty(),"corpus vacío (NMEA_CORPUS_DIR?)");
+  for(const std::string& f:files){
+    std::vector<char> data=loadFile(f);
+    TEST_ASSERT_TRUE_MESSAGE(!data.empty(),f.c_str());
+    BenchResult r=replay(data);
+    char msg[256];
+    snprintf(msg,sizeof(msg),"%-28s %6zu sentences  %8.1f ns/sentence  %.3f allocs/sentence",
+             f.c_str(),r.sentences,r.nsPerSentence,r.allocsPerSentence);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE_MESSAGE(r.sentences>0,f.c_str());
+    TEST_ASSERT_EQUAL_MESSAGE(0,(int)r.allocs,f.c_str());
+#ifdef NMEA_BENCH_MAX_NS
+    TEST_ASSERT_TRUE_MESSAGE(r.nsPerSentence<=NMEA_BENCH_MAX_NS,msg);
+#endif
+  }
+}
+
+// Historial lleno con el corpus (lo llenó test_corpus_replay)
+void test_history_queries(){
+  TEST_ASSERT_TRUE(history.size()>0);
+  HistQuery byCat; byCat.catMask=1u<<NMEA_CAT_AIS;
+  HistQuery byFmt; byFmt.talker=histTalker("GP"); byFmt.formatter=histFormatter("GGA");
+  HistQuery byText; byText.contains="4807.0";
+  size_t a0=allocs;
+  historyBench("category",byCat);
+  historyBench("talker+formatter",byFmt);
+  historyBench("substring",byText);
+  TEST_ASSERT_EQUAL(0,(int)(allocs-a0));
+}
+
+void test_generator_builders(){
+  const char* sensors[]={"GPS","GPS","GPS","WEATHER","HEADING","SOUNDER","VELOCITY","RADAR","TRANSDUCER","AIS"};
+  const char* codes[]  ={"RMC","GGA","GSV","MWV","HDT","DBT","VHW","TTM","XDR","AIVDM"};
+  const int N=sizeof(codes)/sizeof(codes[0]);
+  const int reps=NMEA_BENCH_REPS*100;
+  char b[NMEA_MAX_LINE]; size_t total=0;
+  size_t a0=allocs; uint64_t t0=halMicros();
+  for(int rep=0;rep<reps;rep++) for(int i=0;i<N;i++) total+=nmeaGenerate(b,sizeof(b),sensors[i],codes[i]);
+  uint64_t us=halMicros()-t0; size_t da=allocs-a0;
+  sink=(uint32_t)total;
+  char msg[160];
+  snprintf(msg,sizeof(msg),"generator builders  %8.1f ns/sentence  %.3f allocs/sentence",
+           us*1000.0/((double)reps*N),(double)da/((double)reps*N));
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL(0,(int)da);
+}
+
+int main(int, char**){
+  static std::vector<uint8_t> histMem(HIST_RECS*(sizeof(HistEntry)+HIST_TEXT));
+  history.begin(histMem.data(),histMem.size());
+  UNITY_BEGIN();
+  RUN_TEST(test_corpus_replay);
+  RUN_TEST(test_history_queries);
+  RUN_TEST(test_generator_builders);
+  return UNITY_END();
+}
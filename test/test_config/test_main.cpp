@@ -0,0 +1,109 @@
+#include <unity.h>
+#include <string.h>
+#include "nmea_config.h"
+
+void setUp(){}
+void tearDown(){}
+
+static NmeaConfig sample(){
+  NmeaConfig c; configDefaults(c);
+  c.baud=38400; c.mode=1;
+  c.slots.slot[2].enabled=true; strcpy(c.slots.slot[2].sensor,"CUSTOM"); strcpy(c.slots.slot[2].sentence,"CUSTOM");
+  strcpy(c.slots.slot[2].text,"$GPCUS,FIELD1,FIELD2*4B"); c.slots.slot[2].intervalMs=100;
+  c.filterMask=0x0005; c.monRunning=false; c.genRunning=true;
+  return c;
+}
+
+static void assertSameV1(const NmeaConfig& a, const NmeaConfig& b){
+  TEST_ASSERT_EQUAL(a.baud,b.baud);
+  TEST_ASSERT_EQUAL(a.mode,b.mode);
+  for(int i=0;i<GEN_SLOTS;i++){
+    TEST_ASSERT_EQUAL(a.slots.slot[i].enabled,b.slots.slot[i].enabled);
+    TEST_ASSERT_EQUAL_STRING(a.slots.slot[i].sensor,b.slots.slot[i].sensor);
+    TEST_ASSERT_EQUAL_STRING(a.slots.slot[i].sentence,b.slots.slot[i].sentence);
+    TEST_ASSERT_EQUAL_STRING(a.slots.slot[i].text,b.slots.slot[i].text);
+    TEST_ASSERT_EQUAL(a.slots.slot[i].intervalMs,b.slots.slot[i].intervalMs);
+  }
+}
+
+void test_crc32_vector(){
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926,nmeaCrc32((const uint8_t*)"123456789",9));
+}
+
+void test_roundtrip(){
+  NmeaConfig in=sample(), out; uint8_t b[CONFIG_MAX_BLOB];
+  size_t n=configEncode(in,b,sizeof(b));
+  TEST_ASSERT_TRUE(n>0 && n<300);                 // compacto: strings con largo
+  TEST_ASSERT_TRUE(configDecode(b,n,out));
+  assertSameV1(in,out);
+  TEST_ASSERT_EQUAL_HEX32(0x0005,out.filterMask);
+  TEST_ASSERT_FALSE(out.monRunning);
+  TEST_ASSERT_TRUE(out.genRunning);
+}
+
+void test_corruption_rejected(){
+  NmeaConfig in=sample(), out; configDefaults(out); uint8_t b[CONFIG_MAX_BLOB];
+  size_t n=configEncode(in,b,sizeof(b));
+  for(size_t i=0;i<n;i+=7){
+    uint8_t bad[CONFIG_MAX_BLOB]; memcpy(bad,b,n); bad[i]^=0x40;
+    TEST_ASSERT_FALSE(configDecode(bad,n,out));
+  }
+  TEST_ASSERT_FALSE(configDecode(b,n-1,out));      // truncado
+  TEST_ASSERT_FALSE(configDecode(b,0,out));
+  TEST_ASSERT_EQUAL(4800,out.baud);                // out intacto si falla
+}
+
+void test_future_version_rejected(){
+  NmeaConfig in=sample(), out; uint8_t b[CONFIG_MAX_BLOB];
+  size_t n=configEncode(in,b,sizeof(b));
+  b[4]=CONFIG_VERSION+1; b[5]=0;
+  uint32_t crc=nmeaCrc32(b,n-4);
+  b[n-4]=(uint8_t)crc; b[n-3]=(uint8_t)(crc>>8); b[n-2]=(uint8_t)(crc>>16); b[n-1]=(uint8_t)(crc>>24);
+  TEST_ASSERT_FALSE(configDecode(b,n,out));
+}
+
+void test_migrate_v1_to_current(){
+  NmeaConfig in=sample(), out; uint8_t b[CONFIG_MAX_BLOB];
+  size_t n=configEncode(in,b,sizeof(b),1);
+  TEST_ASSERT_TRUE(n>0);
+  TEST_ASSERT_TRUE(configDecode(b,n,out));
+  assertSameV1(in,out);
+  NmeaConfig d; configDefaults(d);
+  TEST_ASSERT_EQUAL_HEX32(d.filterMask,out.filterMask);   // campos v2 por defecto
+  TEST_ASSERT_FALSE(out.genRunning);
+  // re-guardado en la versión actual conserva todo
+  size_t m=configEncode(out,b,sizeof(b));
+  NmeaConfig again; TEST_ASSERT_TRUE(configDecode(b,m,again));
+  assertSameV1(in,again);
+}
+
+void test_encode_fails_when_too_small(){
+  NmeaConfig in=sample(); uint8_t b[32];
+  TEST_ASSERT_EQUAL(0,configEncode(in,b,sizeof(b)));
+}
+
+void test_debouncer(){
+  SaveDebouncer d(1500,10000);
+  TEST_ASSERT_FALSE(d.due(0));
+  d.touch(100);
+  TEST_ASSERT_FALSE(d.due(1000));
+  TEST_ASSERT_TRUE(d.due(1600));
+  for(uint32_t t=100;t<=9000;t+=200) d.touch(t);           // tecleo continuo
+  TEST_ASSERT_FALSE(d.due(9100));
+  TEST_ASSERT_TRUE(d.due(10100));                           // tope maxMs
+  d.saved();
+  TEST_ASSERT_FALSE(d.pending());
+  TEST_ASSERT_FALSE(d.due(20000));
+}
+
+int main(int, char**){
+  UNITY_BEGIN();
+  RUN_TEST(test_crc32_vector);
+  RUN_TEST(test_roundtrip);
+  RUN_TEST(test_corruption_rejected);
+  RUN_TEST(test_future_version_rejected);
+  RUN_TEST(test_migrate_v1_to_current);
+  RUN_TEST(test_encode_fails_when_too_small);
+  RUN_TEST(test_debouncer);
+  return UNITY_END();
+}
@@ -0,0 +1,146 @@
+#include <unity.h>
+#include <string.h>
+#include "nmea_core.h"
+#include "nmea_ring.h"
+
+void setUp(){}
+void tearDown(){}
+
+// ============ Checksum ============
+void test_checksum_hex(){
+  const char* p="GPRMC,123519,A,4807.038,N,01131.000,E,5.5,054.7,230394,003.1,W";
+  char h[2]; nmeaHex(nmeaXor(p,strlen(p)),h);
+  TEST_ASSERT_EQUAL_CHAR('6',h[0]);
+  TEST_ASSERT_EQUAL_CHAR('0',h[1]);
+  nmeaHex(0x0F,h); TEST_ASSERT_EQUAL_CHAR('0',h[0]); TEST_ASSERT_EQUAL_CHAR('F',h[1]);
+}
+
+void test_finalize_fits_and_overflows(){
+  char out[32];
+  size_t n=nmeaFinalize(out,sizeof(out),'$',"HCHDT,238.5,T",13);
+  TEST_ASSERT_EQUAL_STRING("$HCHDT,238.5,T*25",out);
+  TEST_ASSERT_EQUAL(strlen(out),n);
+  TEST_ASSERT_EQUAL(0,nmeaFinalize(out,17,'$',"HCHDT,238.5,T",13));   // falta el '\0'
+  TEST_ASSERT_EQUAL(17,nmeaFinalize(out,18,'$',"HCHDT,238.5,T",13));
+}
+
+// ============ Clasificador ============
+void test_classify(){
+  struct { const char* l; NmeaCategory c; } cases[]={
+    {"$GPRMC,1",NMEA_CAT_GPS},{"$gnrmc,1",NMEA_CAT_GPS},{"!AIVDM,1",NMEA_CAT_AIS},
+    {"$SDDBT,1",NMEA_CAT_SOUNDER},{"$IIMWV,1",NMEA_CAT_WEATHER},{"$HCHDT,1",NMEA_CAT_HEADING},
+    {"$IIVHW,1",NMEA_CAT_SPEED},{"$IITTM,1",NMEA_CAT_RADAR},{"$IIXDR,1",NMEA_CAT_TRANSDUCER},
+    {"$PGRME,1",NMEA_CAT_OTROS},{"$GPR",NMEA_CAT_OTROS},{"GPRMC,1",NMEA_CAT_OTROS},{"",NMEA_CAT_OTROS},
+  };
+  for(auto& k:cases) TEST_ASSERT_EQUAL_MESSAGE(k.c,nmeaClassify(k.l,strlen(k.l)),k.l);
+  TEST_ASSERT_EQUAL_STRING("OTROS",nmeaCategoryName(NMEA_CAT_OTROS));
+  TEST_ASSERT_EQUAL_STRING("TRANSDUCER",nmeaCategoryName(NMEA_CAT_TRANSDUCER));
+}
+
+void test_is_sentence(){
+  TEST_ASSERT_TRUE(nmeaIsSentence("$GPRMC",6));
+  TEST_ASSERT_TRUE(nmeaIsSentence("!AIVDM",6));
+  TEST_ASSERT_FALSE(nmeaIsSentence("GPRMC",5));
+  TEST_ASSERT_FALSE(nmeaIsSentence("",0));
+}
+
+// ============ Framer ============
+static int feed(NmeaFramer& f, const char* s, char lines[][NMEA_MAX_LINE]){
+  int n=0;
+  for(;*s;s++) if(f.push(*s)){ memcpy(lines[n],f.line(),f.length()); lines[n][f.length()]=0; n++; }
+  return n;
+}
+
+void test_framer_crlf_and_trim(){
+  NmeaFramer f; char l[4][NMEA_MAX_LINE];
+  TEST_ASSERT_EQUAL(3,feed(f,"$A,1\r\n\r\n  $B,2  \n\x01$C\x7f,3\r",l));
+  TEST_ASSERT_EQUAL_STRING("$A,1",l[0]);
+  TEST_ASSERT_EQUAL_STRING("$B,2",l[1]);
+  TEST_ASSERT_EQUAL_STRING("$C,3",l[2]);
+}
+
+void test_framer_partial_across_pushes(){
+  NmeaFramer f; char l[2][NMEA_MAX_LINE];
+  TEST_ASSERT_EQUAL(0,feed(f,"$GPH",l));
+  TEST_ASSERT_EQUAL(1,feed(f,"DT,1\n",l));
+  TEST_ASSERT_EQUAL_STRING("$GPHDT,1",l[0]);
+}
+
+void test_framer_drops_overlong(){
+  NmeaFramer f; char l[2][NMEA_MAX_LINE];
+  char big[NMEA_MAX_LINE+20]; memset(big,'X',sizeof(big)-1); big[sizeof(big)-1]=0;
+  TEST_ASSERT_EQUAL(0,feed(f,big,l));
+  TEST_ASSERT_EQUAL(1,feed(f,"\n$OK\n",l));
+  TEST_ASSERT_EQUAL_STRING("$OK",l[0]);
+  TEST_ASSERT_EQUAL(1,f.overflows());
+}
+
+// ============ Builders ============
+void test_generate_known(){
+  char b[NMEA_MAX_LINE];
+  nmeaGenerate(b,sizeof(b),"GPS","rmc");
+  TEST_ASSERT_EQUAL_STRING("$GPRMC,123519,A,4807.038,N,01131.000,E,5.5,054.7,230394,003.1,W*60",b);
+  nmeaGenerate(b,sizeof(b),"WEATHER","MWV");
+  TEST_ASSERT_EQUAL_STRING("$IIMWV,054.7,R,10.5,N,A*0F",b);
+  nmeaGenerate(b,sizeof(b),"AIS","AIVDM");
+  TEST_ASSERT_EQUAL_STRING("!AIVDM,1,1,,A,13aG?P0P00PD;88MD5MT?wvl0<0,0*69",b);
+  nmeaGenerate(b,sizeof(b),"GPS","GNS");
+  TEST_ASSERT_EQUAL_STRING_LEN("$GNGNS,",b,7);
+}
+
+void test_generate_fallbacks(){
+  char b[NMEA_MAX_LINE];
+  TEST_ASSERT_EQUAL(0,nmeaGenerate(b,sizeof(b),"CUSTOM","RMC"));
+  TEST_ASSERT_EQUAL(0,nmeaGenerate(b,sizeof(b),"GPS","custom"));
+  TEST_ASSERT_EQUAL_STRING("",b);
+  nmeaGenerate(b,sizeof(b),"GPS","MWV");                 // sentencia fuera de su sensor
+  TEST_ASSERT_EQUAL_STRING("$GPMWV,*77",b);
+  TEST_ASSERT_EQUAL(0,nmeaGenerate(b,8,"GPS","RMC"));    // no entra
+}
+
+void test_generated_sentences_classify_back(){
+  const char* sensors[]={"GPS","WEATHER","HEADING","SOUNDER","VELOCITY","RADAR","TRANSDUCER"};
+  const char* codes[]={"RMC","MWV","HDT","DBT","VHW","TTM","XDR"};
+  const NmeaCategory cats[]={NMEA_CAT_GPS,NMEA_CAT_WEATHER,NMEA_CAT_HEADING,NMEA_CAT_SOUNDER,NMEA_CAT_SPEED,NMEA_CAT_RADAR,NMEA_CAT_TRANSDUCER};
+  char b[NMEA_MAX_LINE];
+  for(int i=0;i<7;i++){
+    size_t n=nmeaGenerate(b,sizeof(b),sensors[i],codes[i]);
+    TEST_ASSERT_EQUAL_MESSAGE(cats[i],nmeaClassify(b,n),b);
+  }
+}
+
+// ============ Ring ============
+void test_ring_order_and_wrap(){
+  LineRing<3,8> r;
+  const char* in[]={"a","bb","ccc","dddd"};
+  for(int i=0;i<4;i++) r.push(in[i],strlen(in[i]),(uint8_t)i);
+  TEST_ASSERT_EQUAL(3,r.size());
+  const char* exp[]={"bb","ccc","dddd"}; int k=0;
+  r.forEach([&](const char* t,size_t n,uint8_t tag){
+    TEST_ASSERT_EQUAL_STRING(exp[k],t); TEST_ASSERT_EQUAL(strlen(exp[k]),n); TEST_ASSERT_EQUAL(k+1,tag); k++;
+  });
+  TEST_ASSERT_EQUAL(3,k);
+  r.clear(); TEST_ASSERT_EQUAL(0,r.size());
+}
+
+void test_ring_truncates(){
+  LineRing<2,4> r; r.push("abcdef",6);
+  r.forEach([](const char* t,size_t n,uint8_t){ TEST_ASSERT_EQUAL_STRING("abc",t); TEST_ASSERT_EQUAL(3,n); });
+}
+
+int main(int, char**){
+  UNITY_BEGIN();
+  RUN_TEST(test_checksum_hex);
+  RUN_TEST(test_finalize_fits_and_overflows);
+  RUN_TEST(test_classify);
+  RUN_TEST(test_is_sentence);
+  RUN_TEST(test_framer_crlf_and_trim);
+  RUN_TEST(test_framer_partial_across_pushes);
+  RUN_TEST(test_framer_drops_overlong);
+  RUN_TEST(test_generate_known);
+  RUN_TEST(test_generate_fallbacks);
+  RUN_TEST(test_generated_sentences_classify_back);
+  RUN_TEST(test_ring_order_and_wrap);
+  RUN_TEST(test_ring_truncates);
+  return UNITY_END();
+}
@@ -0,0 +1,179 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "nmea_history.h"
+
+void setUp(){}
+void tearDown(){}
+
+static const size_t REC=sizeof(HistEntry)+HIST_TEXT;
+static uint8_t mem[REC*64];
+
+static void push(NmeaHistory& h, const char* line, uint32_t ms){
+  h.push(line,strlen(line),nmeaClassify(line,strlen(line)),ms);
+}
+static std::vector<uint64_t> all(const NmeaHistory& h, const HistQuery& q){
+  std::vector<uint64_t> v;
+  h.scan(q,h.firstSeq(),h.endSeq(),SIZE_MAX,[&](uint64_t s,const HistEntry&,const char*){ v.push_back(s); return true; });
+  return v;
+}
+
+void test_ids(){
+  TEST_ASSERT_EQUAL_HEX16(('G'<<8)|'P',histTalker("gp"));
+  TEST_ASSERT_EQUAL_HEX32(('R'<<16)|('M'<<8)|'C',histFormatter("RMC"));
+  TEST_ASSERT_EQUAL(0,histTalker("G"));
+  TEST_ASSERT_EQUAL(0,histFormatter("R,"));
+
+  NmeaHistory h; TEST_ASSERT_TRUE(h.begin(mem,sizeof(mem)));
+  push(h,"$GPRMC,123519,A*6A",1);
+  push(h,"!AIVDM,1,1,,A,13aG*5C",2);
+  push(h,"garbage",3);
+  std::vector<HistEntry> e;
+  h.scan(HistQuery(),0,h.endSeq(),SIZE_MAX,[&](uint64_t,const HistEntry& x,const char*){ e.push_back(x); return true; });
+  TEST_ASSERT_EQUAL(3,e.size());
+  TEST_ASSERT_EQUAL(histTalker("GP"),e[0].talker); TEST_ASSERT_EQUAL(histFormatter("RMC"),e[0].formatter);
+  TEST_ASSERT_EQUAL(NMEA_CAT_GPS,e[0].cat);
+  TEST_ASSERT_EQUAL(histTalker("AI"),e[1].talker); TEST_ASSERT_EQUAL(histFormatter("VDM"),e[1].formatter);
+  TEST_ASSERT_EQUAL(0,e[2].talker); TEST_ASSERT_EQUAL(0,e[2].formatter);
+}
+
+void test_capacity_and_wrap(){
+  NmeaHistory h; TEST_ASSERT_TRUE(h.begin(mem,REC*8+REC-1));
+  TEST_ASSERT_EQUAL(8,h.capacity());
+  TEST_ASSERT_FALSE(NmeaHistory().begin(mem,REC-1));
+  char line[32];
+  for(int i=0;i<20;i++){ snprintf(line,sizeof(line),"$IIXDR,%d",i); push(h,line,(uint32_t)i); }
+  TEST_ASSERT_EQUAL(8,h.size());
+  TEST_ASSERT_EQUAL(12,h.firstSeq());
+  TEST_ASSERT_EQUAL(20,h.endSeq());
+  std::vector<std::string> t;
+  h.scan(HistQuery(),0,h.endSeq(),SIZE_MAX,[&](uint64_t,const HistEntry&,const char* s){ t.push_back(s); return true; });
+  TEST_ASSERT_EQUAL(8,t.size());
+  TEST_ASSERT_EQUAL_STRING("$IIXDR,12",t.front().c_str());   // cursor pisado → arranca en la más vieja
+  TEST_ASSERT_EQUAL_STRING("$IIXDR,19",t.back().c_str());
+  h.clear();
+  TEST_ASSERT_EQUAL(0,h.size());
+}
+
+void test_filters(){
+  NmeaHistory h; h.begin(mem,sizeof(mem));
+  push(h,"$GPRMC,1,A*00",0);     // 0
+  push(h,"$GNGGA,1*00",0);       // 1
+  push(h,"$SDDBT,036.4,f*00",0); // 2
+  push(h,"!AIVDM,1,1*00",0);     // 3
+  push(h,"$GPGGA,fix,lost*00",0);// 4
+  push(h,"noise",0);             // 5
+
+  HistQuery q;
+  q.catMask=1u<<NMEA_CAT_GPS;
+  TEST_ASSERT_EQUAL(3,all(h,q).size());
+  q.talker=histTalker("GP");
+  TEST_ASSERT_EQUAL(2,all(h,q).size());
+  q.formatter=histFormatter("GGA");
+  auto v=all(h,q); TEST_ASSERT_EQUAL(1,v.size()); TEST_ASSERT_EQUAL(4,v[0]);
+
+  HistQuery s; s.contains="LOST";          // sin distinguir mayúsculas
+  v=all(h,s); TEST_ASSERT_EQUAL(1,v.size()); TEST_ASSERT_EQUAL(4,v[0]);
+  s.contains="";                           // vacío = sin filtro
+  TEST_ASSERT_EQUAL(6,all(h,s).size());
+  HistQuery o; o.catMask=1u<<NMEA_CAT_OTROS;
+  v=all(h,o); TEST_ASSERT_EQUAL(1,v.size()); TEST_ASSERT_EQUAL(5,v[0]);
+}
+
+void test_time_window(){
+  NmeaHistory h; h.begin(mem,REC*16);
+  for(uint32_t i=0;i<40;i++) push(h,"$GPRMC*00",1000+i*100);   // quedan 24..39 → ms 3400..4900
+  TEST_ASSERT_EQUAL(24,h.seqAt(0));                  // antes de lo guardado → la más vieja
+  TEST_ASSERT_EQUAL(30,h.seqAt(4000));
+  TEST_ASSERT_EQUAL(31,h.seqAt(4001));
+  TEST_ASSERT_EQUAL(40,h.seqAt(999999));             // después → fin
+  size_t n=0;
+  h.scan(HistQuery(),h.seqAt(4000),h.seqAt(4500+1),SIZE_MAX,[&](uint64_t,const HistEntry& e,const char*){
+    TEST_ASSERT_TRUE(e.ms>=4000 && e.ms<=4500); n++; return true; });
+  TEST_ASSERT_EQUAL(6,n);
+}
+
+void test_time_wraps_millis(){
+  NmeaHistory h; h.begin(mem,sizeof(mem));
+  for(uint32_t i=0;i<10;i++) push(h,"$GPRMC*00",0xFFFFFF00u+i*50);   // cruza 2^32
+  TEST_ASSERT_EQUAL(6,h.seqAt(0x00000000u+44));
+}
+
+// Por tramos (budget) y cortando por límite da lo mismo que de una pasada
+void test_chunked_scan_resumes(){
+  NmeaHistory h; h.begin(mem,sizeof(mem));
+  char line[32];
+  for(int i=0;i<50;i++){ snprintf(line,sizeof(line),i%3? "$GPRMC,%d*00" : "$HCHDT,%d*00",i); push(h,line,(uint32_t)i); }
+  HistQuery q; q.formatter=histFormatter("HDT");
+  auto want=all(h,q);
+
+  std::vector<uint64_t> got; uint64_t s=h.firstSeq(), end=h.endSeq();
+  while(s!=end){
+    size_t page=0;
+    // página de 4 resultados, tramos de 7 registros
+    while(s!=end && page<4) s=h.scan(q,s,end,7,[&](uint64_t x,const HistEntry&,const char*){ got.push_back(x); return ++page<4; });
+  }
+  TEST_ASSERT_EQUAL(want.size(),got.size());
+  for(size_t i=0;i<want.size();i++) TEST_ASSERT_EQUAL(want[i],got[i]);
+}
+
+// Más nuevas primero, por tramos: lo mismo que la pasada hacia adelante, al revés
+void test_scan_back_pages(){
+  NmeaHistory h; h.begin(mem,REC*20);
+  char line[32];
+  for(int i=0;i<50;i++){ snprintf(line,sizeof(line),i%3? "$GPRMC,%d*00" : "$HCHDT,%d*00",i); push(h,line,(uint32_t)i); }
+  HistQuery q; q.formatter=histFormatter("HDT");
+  auto want=all(h,q);
+  std::vector<uint64_t> got; uint64_t from=h.firstSeq(), e=h.endSeq();
+  while(e!=from){
+    size_t page=0;
+    while(e!=from && page<2) e=h.scanBack(q,from,e,3,[&](uint64_t x,const HistEntry&,const char*){ got.push_back(x); return ++page<2; });
+  }
+  TEST_ASSERT_EQUAL(want.size(),got.size());
+  for(size_t i=0;i<want.size();i++) TEST_ASSERT_EQUAL(want[want.size()-1-i],got[i]);
+  TEST_ASSERT_EQUAL(h.firstSeq(),h.scanBack(q,0,h.firstSeq(),SIZE_MAX,[&](uint64_t,const HistEntry&,const char*){ return true; }));
+}
+
+// Cap de 10 (no potencia de dos) cruzando 2^32: con seq de 32 bits el índice saltaba
+void test_seq_past_uint32(){
+  NmeaHistory h; TEST_ASSERT_TRUE(h.begin(mem,REC*10,UINT32_MAX-5));
+  char line[32];
+  for(int i=0;i<30;i++){ snprintf(line,sizeof(line),"$IIXDR,%d",i); push(h,line,(uint32_t)i*10); }
+  TEST_ASSERT_EQUAL(10,h.size());
+  TEST_ASSERT_EQUAL((uint64_t)UINT32_MAX-5+30,h.endSeq());
+  TEST_ASSERT_EQUAL(h.endSeq()-10,h.firstSeq());
+  std::vector<std::string> t;
+  h.scan(HistQuery(),0,h.endSeq(),SIZE_MAX,[&](uint64_t,const HistEntry&,const char* s){ t.push_back(s); return true; });
+  TEST_ASSERT_EQUAL(10,t.size());
+  for(int i=0;i<10;i++){ snprintf(line,sizeof(line),"$IIXDR,%d",20+i); TEST_ASSERT_EQUAL_STRING(line,t[i].c_str()); }
+  TEST_ASSERT_EQUAL(h.firstSeq()+5,h.seqAt(250));
+  h.clear();
+  TEST_ASSERT_EQUAL(0,h.size());
+  push(h,"$IIXDR,new",999);
+  TEST_ASSERT_EQUAL((uint64_t)UINT32_MAX-5+30,h.firstSeq());   // un cursor viejo no apunta a datos nuevos
+}
+
+void test_truncates_long_lines(){
+  NmeaHistory h; h.begin(mem,sizeof(mem));
+  char line[NMEA_MAX_LINE]; memset(line,'A',sizeof(line)); line[0]='$'; line[sizeof(line)-1]=0;
+  push(h,line,0);
+  h.scan(HistQuery(),0,1,1,[&](uint64_t,const HistEntry& e,const char* t){
+    TEST_ASSERT_EQUAL(HIST_TEXT-1,e.len); TEST_ASSERT_EQUAL(HIST_TEXT-1,strlen(t)); return true; });
+}
+
+int main(int, char**){
+  UNITY_BEGIN();
+  RUN_TEST(test_ids);
+  RUN_TEST(test_capacity_and_wrap);
+  RUN_TEST(test_filters);
+  RUN_TEST(test_time_window);
+  RUN_TEST(test_time_wraps_millis);
+  RUN_TEST(test_chunked_scan_resumes);
+  RUN_TEST(test_scan_back_pages);
+  RUN_TEST(test_seq_past_uint32);
+  RUN_TEST(test_truncates_long_lines);
+  return UNITY_END();
+}
@@ -0,0 +1,44 @@
+#include <unity.h>
+#include "nmea_led.h"
+
+void setUp(){}
+void tearDown(){}
+
+void test_mailbox_coalesces(){
+  LedMailbox mb;
+  TEST_ASSERT_TRUE(mb.post(LED_RX_OK));     // vacío → despertar
+  TEST_ASSERT_FALSE(mb.post(LED_RX_OK));
+  TEST_ASSERT_FALSE(mb.post(LED_TX));
+  TEST_ASSERT_EQUAL_HEX32((1u<<LED_RX_OK)|(1u<<LED_TX),mb.take());
+  TEST_ASSERT_EQUAL_HEX32(0,mb.take());
+  TEST_ASSERT_TRUE(mb.post(LED_BOOT));
+}
+
+void test_scheduler_priority_and_hold(){
+  LedScheduler s(50);
+  TEST_ASSERT_TRUE(s.step((1u<<LED_RX_OK)|(1u<<LED_RX_BAD),1000));
+  TEST_ASSERT_EQUAL_HEX32(0xFF0000,s.color());              // inválida gana
+  TEST_ASSERT_EQUAL(30,s.msUntilOff(1020));
+  TEST_ASSERT_FALSE(s.step(0,1049));
+  TEST_ASSERT_TRUE(s.step(0,1050));
+  TEST_ASSERT_EQUAL_HEX32(0,s.color());
+  TEST_ASSERT_EQUAL_HEX32(UINT32_MAX,s.msUntilOff(1050));
+}
+
+void test_scheduler_same_color_no_refresh(){
+  LedScheduler s(50);
+  TEST_ASSERT_TRUE(s.step(1u<<LED_RX_OK,0));
+  TEST_ASSERT_FALSE(s.step(1u<<LED_RX_OK,20));               // mismo color: solo extiende
+  TEST_ASSERT_FALSE(s.step(0,60));
+  TEST_ASSERT_TRUE(s.step(0,70));
+  TEST_ASSERT_TRUE(s.step(1u<<LED_TX,80));
+  TEST_ASSERT_EQUAL_HEX32(0x0000FF,s.color());
+}
+
+int main(int, char**){
+  UNITY_BEGIN();
+  RUN_TEST(test_mailbox_coalesces);
+  RUN_TEST(test_scheduler_priority_and_hold);
+  RUN_TEST(test_scheduler_same_color_no_refresh);
+  return UNITY_END();
+}
@@ -0,0 +1,181 @@
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "nmea_ota.h"
+
+// ===== Sink de flash simulado =====
+struct MockFlash : OtaSink {
+  std::vector<uint8_t> data;
+  bool   begun=false, committed=false, aborted=false;
+  size_t failAt=(size_t)-1;        // falla la escritura que cruza este offset
+  size_t beginSize=0;
+  bool   begin(size_t s) override { begun=true; beginSize=s; data.clear(); return true; }
+  size_t write(const uint8_t* d, size_t n) override {
+    if(data.size()+n>failAt) return 0;
+    data.insert(data.end(),d,d+n); return n;
+  }
+  bool   end() override { committed=true; return true; }
+  void   abort() override { aborted=true; }
+  const char* error() override { return "flash write"; }
+};
+
+// Imagen con forma de app ESP32: magic, hash_appended=1 y el SHA-256 del resto al final
+static std::vector<uint8_t> image(size_t n){
+  std::vector<uint8_t> v(n); for(size_t i=0;i<n;i++) v[i]=(uint8_t)(i*31+7);
+  v[0]=0xE9; v[23]=1;
+  Sha256 s; s.update(v.data(),n-32); s.finish(v.data()+n-32);
+  return v;
+}
+static void hexOf(const std::vector<uint8_t>& v, char out[65]){
+  Sha256 s; s.update(v.data(),v.size()); uint8_t d[32]; s.finish(d); Sha256::toHex(d,out);
+}
+// Escribe en bloques del tamaño de HTTP_UPLOAD_BUFLEN
+static bool stream(OtaPipeline& p, const std::vector<uint8_t>& v, uint32_t& t){
+  for(size_t o=0;o<v.size();o+=1436){
+    size_t n=v.size()-o<1436? v.size()-o : 1436;
+    if(!p.write(v.data()+o,n,t+=2)) return false;
+  }
+  return true;
+}
+
+void setUp(){}
+void tearDown(){}
+
+// ============ SHA-256 ============
+void test_sha256_vectors(){
+  char hex[65]; uint8_t d[32];
+  Sha256 a; a.finish(d); Sha256::toHex(d,hex);
+  TEST_ASSERT_EQUAL_STRING("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",hex);
+  Sha256 b; b.update((const uint8_t*)"abc",3); b.finish(d); Sha256::toHex(d,hex);
+  TEST_ASSERT_EQUAL_STRING("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",hex);
+  Sha256 c; const char* m="abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  for(size_t i=0;i<strlen(m);i++) c.update((const uint8_t*)m+i,1);   // byte a byte
+  c.finish(d); Sha256::toHex(d,hex);
+  TEST_ASSERT_EQUAL_STRING("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",hex);
+
+  Sha256 e; e.update((const uint8_t*)"ab",2);
+  Sha256 f=e; f.update((const uint8_t*)"c",1); f.finish(d); Sha256::toHex(d,hex);   // copia a mitad de camino
+  TEST_ASSERT_EQUAL_STRING("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",hex);
+  e.finish(d); Sha256::toHex(d,hex);
+  TEST_ASSERT_EQUAL_STRING("fb8e20fc2e4c3f248c60c39bd652f3c1347298bb977b8b4d5903b85055620603",hex);
+}
+
+void test_sha256_from_hex(){
+  uint8_t d[32];
+  TEST_ASSERT_TRUE(Sha256::fromHex("BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD",d));
+  TEST_ASSERT_EQUAL_HEX8(0xBA,d[0]);
+  TEST_ASSERT_FALSE(Sha256::fromHex("ba78",d));
+  TEST_ASSERT_FALSE(Sha256::fromHex("zz7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",d));
+}
+
+// ============ Pipeline ============
+void test_ota_verified_commit(){
+  MockFlash f; OtaPipeline p(f); uint32_t t=1000;
+  std::vector<uint8_t> img=image(100000); char hex[65]; hexOf(img,hex);
+  TEST_ASSERT_TRUE(p.begin(img.size(),hex,t));
+  TEST_ASSERT_EQUAL(img.size(),f.beginSize);
+  TEST_ASSERT_TRUE(stream(p,img,t));
+  TEST_ASSERT_TRUE(p.finish(t));
+  TEST_ASSERT_EQUAL(OTA_OK,p.state());
+  TEST_ASSERT_TRUE(p.verified());
+  TEST_ASSERT_TRUE(f.committed); TEST_ASSERT_FALSE(f.aborted);
+  TEST_ASSERT_TRUE(f.data==img);
+  TEST_ASSERT_EQUAL_STRING(hex,p.digestHex());
+  TEST_ASSERT_TRUE(p.bytesPerSec(t+5000)>0);
+}
+
+void test_ota_digest_mismatch_aborts(){
+  MockFlash f; OtaPipeline p(f); uint32_t t=0;
+  std::vector<uint8_t> img=image(5000); char hex[65]; hexOf(img,hex);
+  hex[0]=(hex[0]=='0')? '1' : '0';
+  TEST_ASSERT_TRUE(p.begin(0,hex,t));
+  TEST_ASSERT_TRUE(stream(p,img,t));
+  TEST_ASSERT_FALSE(p.finish(t));
+  TEST_ASSERT_EQUAL(OTA_FAILED,p.state());
+  TEST_ASSERT_EQUAL_STRING("sha256 mismatch",p.error());
+  TEST_ASSERT_FALSE(f.committed); TEST_ASSERT_TRUE(f.aborted);
+}
+
+// Sin digest pegado igual se verifica el hash embebido en la imagen
+void test_ota_corrupt_image_rejected(){
+  MockFlash f; OtaPipeline p(f); uint32_t t=0;
+  std::vector<uint8_t> img=image(9000);
+  img[4321]^=1;
+  TEST_ASSERT_TRUE(p.begin(img.size(),NULL,t));
+  // bloques de tamaño irregular: la ventana de 32 bytes cruza cortes de todo tipo
+  static const size_t CH[]={1,7,31,32,33,500,1436};
+  for(size_t o=0,k=0;o<img.size();k++){
+    size_t n=CH[k%7]; if(n>img.size()-o) n=img.size()-o;
+    TEST_ASSERT_TRUE(p.write(img.data()+o,n,t)); o+=n;
+  }
+  TEST_ASSERT_FALSE(p.finish(t));
+  TEST_ASSERT_EQUAL_STRING("image sha256 mismatch",p.error());
+  TEST_ASSERT_FALSE(f.committed); TEST_ASSERT_TRUE(f.aborted);
+}
+
+void test_ota_rejects_non_images(){
+  uint32_t t=0;
+  std::vector<uint8_t> img=image(3000); img[0]=0x00;
+  MockFlash f; OtaPipeline p(f);
+  TEST_ASSERT_TRUE(p.begin(0,NULL,t));
+  TEST_ASSERT_FALSE(stream(p,img,t));                          // corta en el primer bloque
+  TEST_ASSERT_EQUAL_STRING("not an app image",p.error());
+  TEST_ASSERT_TRUE(f.aborted);
+
+  img=image(3000); img[23]=0;
+  MockFlash g; OtaPipeline q(g);
+  TEST_ASSERT_TRUE(q.begin(0,NULL,t));
+  TEST_ASSERT_FALSE(stream(q,img,t));
+  TEST_ASSERT_EQUAL_STRING("image has no appended sha256",q.error());
+
+  MockFlash h; OtaPipeline r(h);
+  TEST_ASSERT_TRUE(r.begin(0,NULL,t));
+  TEST_ASSERT_TRUE(r.write(img.data(),10,t));
+  TEST_ASSERT_FALSE(r.finish(t));
+  TEST_ASSERT_EQUAL_STRING("not an app image",r.error());
+}
+
+void test_ota_unverified_reports_digest(){
+  MockFlash f; OtaPipeline p(f); uint32_t t=0;
+  std::vector<uint8_t> img=image(3000); char hex[65]; hexOf(img,hex);
+  TEST_ASSERT_TRUE(p.begin(0,"",t));
+  TEST_ASSERT_TRUE(stream(p,img,t));
+  TEST_ASSERT_TRUE(p.finish(t));
+  TEST_ASSERT_FALSE(p.verified());
+  TEST_ASSERT_EQUAL_STRING(hex,p.digestHex());
+}
+
+void test_ota_flash_error_and_size_checks(){
+  MockFlash f; f.failAt=4096; OtaPipeline p(f); uint32_t t=0;
+  std::vector<uint8_t> img=image(10000);
+  TEST_ASSERT_TRUE(p.begin(0,NULL,t));
+  TEST_ASSERT_FALSE(stream(p,img,t));
+  TEST_ASSERT_EQUAL(OTA_FAILED,p.state());
+  TEST_ASSERT_EQUAL_STRING("flash write",p.error());
+  TEST_ASSERT_TRUE(f.aborted);
+  TEST_ASSERT_FALSE(p.write(img.data(),1,t));                  // ya no acepta datos
+
+  MockFlash g; OtaPipeline q(g);
+  TEST_ASSERT_TRUE(q.begin(img.size()+1,NULL,t));
+  TEST_ASSERT_TRUE(stream(q,img,t));
+  TEST_ASSERT_FALSE(q.finish(t));
+  TEST_ASSERT_EQUAL_STRING("size mismatch",q.error());
+
+  MockFlash h; OtaPipeline r(h);
+  TEST_ASSERT_FALSE(r.begin(0,"1234",t));
+  TEST_ASSERT_EQUAL_STRING("bad sha256",r.error());
+  TEST_ASSERT_FALSE(h.begun);
+}
+
+int main(int, char**){
+  UNITY_BEGIN();
+  RUN_TEST(test_sha256_vectors);
+  RUN_TEST(test_sha256_from_hex);
+  RUN_TEST(test_ota_verified_commit);
+  RUN_TEST(test_ota_digest_mismatch_aborts);
+  RUN_TEST(test_ota_corrupt_image_rejected);
+  RUN_TEST(test_ota_rejects_non_images);
+  RUN_TEST(test_ota_unverified_reports_digest);
+  RUN_TEST(test_ota_flash_error_and_size_checks);
+  return UNITY_END();
+}
@@ -0,0 +1,156 @@
+#include <unity.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <string>
+#include "nmea_slots.h"
+
+void setUp(){}
+void tearDown(){}
+
+static bool parse(const char* body, SlotTable& t, char* err){
+  return slotsParse(body,strlen(body),t,err,64);
+}
+
+// ============ Normalize ============
+void test_normalize(){
+  char b[NMEA_MAX_LINE];
+  nmeaNormalize(b,sizeof(b),"$HCHDT,238.5,T*00");
+  TEST_ASSERT_EQUAL_STRING("$HCHDT,238.5,T*25",b);
+  nmeaNormalize(b,sizeof(b),"HCHDT,238.5,T");
+  TEST_ASSERT_EQUAL_STRING("$HCHDT,238.5,T*25",b);
+  nmeaNormalize(b,sizeof(b),"aivdm,1,1,,A,13aG?P0P00PD;88MD5MT?wvl0<0,0");
+  TEST_ASSERT_EQUAL('!',b[0]);
+  TEST_ASSERT_EQUAL(0,nmeaNormalize(b,sizeof(b),"   "));
+}
+
+// ============ Parse / Format ============
+void test_parse_full_batch(){
+  SlotTable t; slotDefaults(t); char err[64];
+  TEST_ASSERT_TRUE(parse("0|1|GPS|GGA|1000|\r\n"
+                         "1|1|AIS|AIVDO|2000|!AIVDO,1,1,,A,13aG?P0P00PD;88MD5MT?wvl0<0,0\n"
+                         "2|0|CUSTOM|X|100|GPCUS,A|B\n"
+                         "3|1|HEADING|HDT|10|$HCHDT,238.5,T*00",t,err));
+  TEST_ASSERT_TRUE(t.slot[0].enabled);
+  TEST_ASSERT_EQUAL_STRING("GGA",t.slot[0].sentence);
+  TEST_ASSERT_EQUAL(1000,t.slot[0].intervalMs);
+  TEST_ASSERT_EQUAL_STRING("",t.slot[0].text);
+  TEST_ASSERT_EQUAL_STRING_LEN("!AIVDO,1,1,,A,13aG?P0P00PD;88MD5MT?wvl0<0,0*",t.slot[1].text,44);
+  TEST_ASSERT_EQUAL_STRING("CUSTOM",t.slot[2].sentence);           // CUSTOM arrastra la sentencia
+  TEST_ASSERT_EQUAL_STRING_LEN("$GPCUS,A|B*",t.slot[2].text,11);    // texto hasta fin de línea
+  TEST_ASSERT_EQUAL(GEN_MIN_INTERVAL,t.slot[3].intervalMs);
+  TEST_ASSERT_EQUAL_STRING("$HCHDT,238.5,T*25",t.slot[3].text);
+}
+
+void test_parse_partial_keeps_others(){
+  SlotTable t; slotDefaults(t); char err[64];
+  TEST_ASSERT_TRUE(parse("2|1|VELOCITY|VLW|250|\n",t,err));
+  TEST_ASSERT_TRUE(t.slot[0].enabled);
+  TEST_ASSERT_EQUAL_STRING("RMC",t.slot[0].sentence);
+  TEST_ASSERT_TRUE(t.slot[2].enabled);
+  TEST_ASSERT_EQUAL(250,t.slot[2].intervalMs);
+}
+
+void test_parse_rejects_whole_batch(){
+  const char* bad[]={
+    "0|1|GPS|RMC|500|\n4|1|GPS|RMC|500|\n",     // slot fuera de rango
+    "0|1|GPS|RMC|500|\n1|2|GPS|RMC|500|\n",     // enabled inválido
+    "0|1|GPS|RMC|500|\n1|1|GPS|RMC|abc|\n",     // intervalo
+    "0|1|GPS|RMC|500|\n1|1|GP S|RMC|500|\n",    // sensor
+    "0|1|GPS|RMC|500\n",                        // faltan campos
+    "0|1|VERYLONGSENSOR|RMC|500|\n",
+    "0|1|GPS|RMC|500|\n|1|GPS|GGA|1000|\n",   // slot vacío (strtol daba 0)
+    "0|1|GPS|RMC|500|\n 1|1|GPS|RMC|500|\n",
+    "0|1|GPS|RMC|500|\n+2|1|GPS|RMC|500|\n",
+    "0|1|GPS|RMC|500|\n1|1|GPS|RMC| 700|\n",
+    "0|1|GPS|RMC|500|\n1|1|GPS|RMC|+700|\n",
+    "0|1|GPS|RMC|500|\n1|1|GPS|RMC||\n",
+  };
+  for(const char* b:bad){
+    SlotTable t; slotDefaults(t); SlotTable before=t; char err[64];
+    TEST_ASSERT_FALSE_MESSAGE(parse(b,t,err),b);
+    TEST_ASSERT_TRUE_MESSAGE(memcmp(&t,&before,sizeof(t))==0,b);
+    TEST_ASSERT_EQUAL_STRING_LEN("line ",err,5);
+  }
+}
+
+// maxlength del editor: GEN_TEXT_MAX entra normalizado, uno más no
+void test_parse_text_limit(){
+  std::string body="0|1|CUSTOM|CUSTOM|500|"+std::string(GEN_TEXT_MAX,'A')+"\n";
+  SlotTable t; slotDefaults(t); char err[64];
+  TEST_ASSERT_TRUE(parse(body.c_str(),t,err));
+  TEST_ASSERT_EQUAL(GEN_TEXT_MAX+4,strlen(t.slot[0].text));
+  body="0|1|CUSTOM|CUSTOM|500|"+std::string(GEN_TEXT_MAX+1,'A')+"\n";
+  TEST_ASSERT_FALSE(parse(body.c_str(),t,err));
+  TEST_ASSERT_EQUAL_STRING("line 1: text too long",err);
+}
+
+// Solo espacios = vacío: vuelve a la plantilla, no "text too long"
+void test_parse_blank_text_is_template(){
+  SlotTable t; slotDefaults(t); char err[64];
+  TEST_ASSERT_TRUE(parse("0|1|GPS|RMC|500|$GPRMC,1*00\n",t,err));
+  TEST_ASSERT_TRUE(t.slot[0].text[0]!=0);
+  TEST_ASSERT_TRUE(parse("0|1|GPS|RMC|500|   \n",t,err));
+  TEST_ASSERT_EQUAL_STRING("",t.slot[0].text);
+  TEST_ASSERT_TRUE(parse("0|1|GPS|RMC|500|  $GPRMC,2\n",t,err));
+  TEST_ASSERT_EQUAL_STRING("$GPRMC,2*",std::string(t.slot[0].text,9).c_str());
+}
+
+void test_format_roundtrip(){
+  SlotTable t; slotDefaults(t); char err[64];
+  TEST_ASSERT_TRUE(parse("1|1|GPS|VTG|100|$GPVTG,1*00\n",t,err));
+  char out[1024]; size_t n=slotsFormat(t,out,sizeof(out));
+  TEST_ASSERT_TRUE(n>0);
+  SlotTable u; memset(&u,0,sizeof(u));
+  TEST_ASSERT_TRUE(slotsParse(out,n,u,err,sizeof(err)));
+  TEST_ASSERT_TRUE(memcmp(&t,&u,sizeof(t))==0);
+  TEST_ASSERT_EQUAL(0,slotsFormat(t,out,16));
+}
+
+// ============ SwapBuffer ============
+void test_swap_publish(){
+  SwapBuffer<SlotTable> sb; slotDefaults(sb.edit()); sb.publish();
+  SlotTable& e=sb.edit(); e.slot[1].enabled=true;
+  TEST_ASSERT_FALSE(sb.current().slot[1].enabled);     // sin publicar no se ve
+  sb.publish();
+  const SlotTable& r=sb.acquire();
+  TEST_ASSERT_TRUE(r.slot[1].enabled);
+  sb.release();
+}
+
+// Un lector nunca ve una tabla mezclada aunque el escritor publique sin parar
+void test_swap_no_torn_reads(){
+  SwapBuffer<SlotTable> sb;
+  { SlotTable& e=sb.edit(); slotDefaults(e); for(auto& s:e.slot){ s.intervalMs=1; s.text[0]=1; } } sb.publish();
+  std::atomic<bool> stop{false}; std::atomic<int> torn{0}, reads{0};
+  std::thread reader([&]{
+    while(!stop.load()){
+      const SlotTable& t=sb.acquire();
+      uint32_t v=t.slot[0].intervalMs;
+      for(const GenSlot& s:t.slot) if(s.intervalMs!=v || (uint8_t)s.text[0]!=(uint8_t)(v&0x7F)) torn++;
+      sb.release(); reads++;
+    }
+  });
+  for(uint32_t v=2;v<20000 || reads.load()<1000;v++){   // hasta que el lector haya corrido
+    SlotTable& e=sb.edit();
+    for(GenSlot& s:e.slot){ s.intervalMs=v; s.text[0]=(char)(v&0x7F); }
+    sb.publish();
+  }
+  stop=true; reader.join();
+  TEST_ASSERT_EQUAL(0,torn.load());
+  TEST_ASSERT_TRUE(reads.load()>0);
+}
+
+int main(int, char**){
+  UNITY_BEGIN();
+  RUN_TEST(test_normalize);
+  RUN_TEST(test_parse_full_batch);
+  RUN_TEST(test_parse_partial_keeps_others);
+  RUN_TEST(test_parse_rejects_whole_batch);
+  RUN_TEST(test_parse_text_limit);
+  RUN_TEST(test_parse_blank_text_is_template);
+  RUN_TEST(test_format_roundtrip);
+  RUN_TEST(test_swap_publish);
+  RUN_TEST(test_swap_no_torn_reads);
+  return UNITY_END();
+}